@@ -0,0 +1,319 @@
+/*
+ * Copyright (c) 2025 Orazio Franco <robora2025@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * @file fusion_bench.cpp
+ * @brief Host benchmark and accuracy comparison of the attitude filters of `fusion.h`.
+ *
+ * Runs every filter on the same IMU trace and reports the pitch/roll error
+ * (RMS and max, after a 2 s settling time), the yaw drift and the host time
+ * per update. Double-precision Mahony and Madgwick run alongside, so the
+ * error due to the fixed-point arithmetic is visible on its own.
+ *
+ * Without arguments (or with `-`) a synthetic 60 s trace is generated (known attitude,
+ * gyro bias and noise, accelerometer noise and bumps). With a CSV file the
+ * trace is read from it: one sample per line, `ax,ay,az,gx,gy,gz` in raw
+ * LSB, optionally followed by the reference `pitch,roll,yaw` in degrees;
+ * without reference the double-precision Mahony is used.
+ *
+ * Build and run from the repository root:
+ * @code
+ * g++ -O2 -std=c++17 -Iinclude bench/fusion_bench.cpp -o fusion_bench && ./fusion_bench [trace.csv|-] [odr]
+ * @endcode
+ * Host times only rank the filters; the cycles on the ESP32-C3 are in `info10`.
+ */
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "fusion.h"
+
+#define ACC_LSB_G 8192.0
+#define GYR_LSB_DPS 65.5
+
+struct Sample
+{
+    int16_t acc[3];
+    int16_t gyr[3];
+    double ref[3]; // pitch, roll, yaw in degrees
+};
+
+// quaternione double: q *= (0, w) * dt / 2, poi normalizza
+static void quatIntegrate(double q[4], const double w[3], double dt)
+{
+    const double h[3] = {w[0] * dt / 2, w[1] * dt / 2, w[2] * dt / 2};
+    const double n[4] = {q[0] - q[1] * h[0] - q[2] * h[1] - q[3] * h[2], q[1] + q[0] * h[0] + q[2] * h[2] - q[3] * h[1],
+                         q[2] + q[0] * h[1] - q[1] * h[2] + q[3] * h[0], q[3] + q[0] * h[2] + q[1] * h[1] - q[2] * h[0]};
+    const double k = 1.0 / std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2] + n[3] * n[3]);
+    for (int i = 0; i < 4; i++)
+        q[i] = n[i] * k;
+}
+
+static void quatEuler(const double q[4], double e[3])
+{
+    const double w = q[0], x = q[1], y = q[2], z = q[3];
+    const double sp = std::fmax(-1.0, std::fmin(1.0, 2 * (w * y - x * z)));
+    e[0] = std::asin(sp) * 180 / M_PI;
+    e[1] = std::atan2(2 * (w * x + y * z), w * w - x * x - y * y + z * z) * 180 / M_PI;
+    e[2] = std::atan2(2 * (w * z + x * y), w * w + x * x - y * y - z * z) * 180 / M_PI;
+}
+
+static int16_t sat16(double v)
+{
+    return (int16_t)std::lround(std::fmax(-32768.0, std::fmin(32767.0, v)));
+}
+
+// traccia sintetica: velocità angolari note, bias e rumore del giroscopio,
+// rumore e urti sull'accelerometro
+static std::vector<Sample> synthTrace(double odr, double seconds)
+{
+    std::mt19937 rng(42);
+    std::normal_distribution<double> gn(0.0, 0.1), an(0.0, 0.01);
+    const double bias[3] = {1.5, -1.0, 0.5}; // dps
+    const int sub = 10;
+    const double dt = 1.0 / odr;
+    double q[4] = {1, 0, 0, 0};
+    std::vector<Sample> out;
+    for (int k = 0; k < (int)(seconds * odr); k++)
+    {
+        double w[3];
+        for (int s = 0; s < sub; s++)
+        {
+            const double t = (k + (s + 0.5) / sub) * dt;
+            w[0] = 40 * std::sin(2 * M_PI * 0.30 * t) * M_PI / 180;
+            w[1] = 30 * std::sin(2 * M_PI * 0.21 * t + 0.5) * M_PI / 180;
+            w[2] = 20 * std::sin(2 * M_PI * 0.10 * t) * M_PI / 180;
+            quatIntegrate(q, w, dt / sub);
+        }
+        Sample smp;
+        const double x = q[1], y = q[2], z = q[3], qw = q[0];
+        double g[3] = {2 * (x * z - qw * y), 2 * (qw * x + y * z), qw * qw - x * x - y * y + z * z};
+        if (k % 200 < 10) // urto di 0,1 s ogni 2 s
+            g[0] += 0.3;
+        for (int i = 0; i < 3; i++)
+        {
+            smp.acc[i] = sat16((g[i] + an(rng)) * ACC_LSB_G);
+            smp.gyr[i] = sat16((w[i] * 180 / M_PI + bias[i] + gn(rng)) * GYR_LSB_DPS);
+        }
+        quatEuler(q, smp.ref);
+        out.push_back(smp);
+    }
+    return out;
+}
+
+static std::vector<Sample> csvTrace(const char *path, bool &hasRef)
+{
+    std::vector<Sample> out;
+    FILE *fp = fopen(path, "r");
+    if (!fp)
+    {
+        perror(path);
+        exit(1);
+    }
+    char line[256];
+    hasRef = true;
+    while (fgets(line, sizeof(line), fp))
+    {
+        int v[6];
+        double r[3];
+        int n = sscanf(line, "%d,%d,%d,%d,%d,%d,%lf,%lf,%lf", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &r[0], &r[1], &r[2]);
+        if (n < 6)
+            continue; // intestazione o riga vuota
+        Sample s;
+        for (int i = 0; i < 3; i++)
+        {
+            s.acc[i] = (int16_t)v[i];
+            s.gyr[i] = (int16_t)v[3 + i];
+            s.ref[i] = n == 9 ? r[i] : 0;
+        }
+        hasRef = hasRef && n == 9;
+        out.push_back(s);
+    }
+    fclose(fp);
+    return out;
+}
+
+// riferimenti in doppia precisione, stesse equazioni di fusion.h
+struct RefFilter
+{
+    bool madgwick;
+    double kp, ki, beta, dt;
+    double q[4] = {1, 0, 0, 0};
+    double bi[3] = {0, 0, 0};
+    bool valid = false;
+
+    void update(const int16_t acc[3], const int16_t gyr[3])
+    {
+        double a[3] = {(double)acc[0], (double)acc[1], (double)acc[2]};
+        const double an = std::sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+        for (auto &v : a)
+            v /= an;
+        if (!valid)
+        {
+            const double n = std::sqrt(2 * (1 + a[2]));
+            q[0] = (1 + a[2]) / n, q[1] = a[1] / n, q[2] = -a[0] / n, q[3] = 0;
+            valid = true;
+            return;
+        }
+        double w[3];
+        for (int i = 0; i < 3; i++)
+            w[i] = gyr[i] / GYR_LSB_DPS * M_PI / 180;
+        const double qw = q[0], x = q[1], y = q[2], z = q[3];
+        if (!madgwick)
+        {
+            const double v[3] = {2 * (x * z - qw * y), 2 * (qw * x + y * z), qw * qw - x * x - y * y + z * z};
+            const double e[3] = {a[1] * v[2] - a[2] * v[1], a[2] * v[0] - a[0] * v[2], a[0] * v[1] - a[1] * v[0]};
+            for (int i = 0; i < 3; i++)
+            {
+                bi[i] += ki * e[i] * dt;
+                w[i] += kp * e[i] + bi[i];
+            }
+            quatIntegrate(q, w, dt);
+            return;
+        }
+        const double f0 = 2 * (x * z - qw * y) - a[0], f1 = 2 * (qw * x + y * z) - a[1],
+                     f2 = qw * qw - x * x - y * y + z * z - a[2];
+        double s[4] = {-2 * y * f0 + 2 * x * f1, 2 * z * f0 + 2 * qw * f1 - 4 * x * f2,
+                       -2 * qw * f0 + 2 * z * f1 - 4 * y * f2, 2 * x * f0 + 2 * y * f1};
+        const double sn = std::sqrt(s[0] * s[0] + s[1] * s[1] + s[2] * s[2] + s[3] * s[3]);
+        const double h[3] = {w[0] * dt / 2, w[1] * dt / 2, w[2] * dt / 2};
+        double n[4] = {qw - x * h[0] - y * h[1] - z * h[2], x + qw * h[0] + y * h[2] - z * h[1],
+                       y + qw * h[1] - x * h[2] + z * h[0], z + qw * h[2] + x * h[1] - y * h[0]};
+        for (int i = 0; i < 4; i++)
+            n[i] -= sn > 0 ? beta * dt * s[i] / sn : 0;
+        const double k = 1.0 / std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2] + n[3] * n[3]);
+        for (int i = 0; i < 4; i++)
+            q[i] = n[i] * k;
+    }
+    void euler(double e[3]) const { quatEuler(q, e); }
+};
+
+struct Result
+{
+    double rms[2] = {0, 0}, max[2] = {0, 0}, yawDrift = 0, ns = 0;
+};
+
+static double angleDiff(double a, double b)
+{
+    double d = std::fmod(a - b + 540.0, 360.0) - 180.0;
+    return d;
+}
+
+template <typename Step, typename Euler>
+static Result run(const std::vector<Sample> &tr, double odr, const std::vector<double> *ref, Step step, Euler euler)
+{
+    Result r;
+    const size_t settle = (size_t)(2 * odr);
+    std::vector<double> out(tr.size() * 3);
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t k = 0; k < tr.size(); k++)
+    {
+        step(tr[k]);
+        euler(&out[k * 3]);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    r.ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / tr.size();
+    size_t n = 0;
+    double yaw0 = 0, ref0 = 0;
+    for (size_t k = settle; k < tr.size(); k++, n++)
+    {
+        const double *want = ref ? &(*ref)[k * 3] : tr[k].ref;
+        for (int i = 0; i < 2; i++)
+        {
+            const double d = angleDiff(out[k * 3 + i], want[i]);
+            r.rms[i] += d * d;
+            r.max[i] = std::fmax(r.max[i], std::fabs(d));
+        }
+        if (k == settle)
+            yaw0 = out[k * 3 + 2], ref0 = want[2];
+        r.yawDrift = angleDiff(out[k * 3 + 2] - yaw0, want[2] - ref0);
+    }
+    for (int i = 0; i < 2; i++)
+        r.rms[i] = n ? std::sqrt(r.rms[i] / n) : 0;
+    return r;
+}
+
+int main(int argc, char **argv)
+{
+    const double odr = argc > 2 ? atof(argv[2]) : 100.0;
+    bool hasRef = true;
+    const bool synth = argc < 2 || strcmp(argv[1], "-") == 0;
+    std::vector<Sample> tr = synth ? synthTrace(odr, 60.0) : csvTrace(argv[1], hasRef);
+    if (tr.empty())
+    {
+        fprintf(stderr, "empty trace\n");
+        return 1;
+    }
+    // stessi guadagni del firmware (all_define.h)
+    const FusionParams p = {(float)odr, (float)ACC_LSB_G, (float)GYR_LSB_DPS, 0.98f, 1.0f, 0.05f, 0.05f};
+
+    std::vector<double> mahonyRef(tr.size() * 3);
+    {
+        RefFilter m{false, p.kp, p.ki, p.beta, 1.0 / odr};
+        for (size_t k = 0; k < tr.size(); k++)
+        {
+            m.update(tr[k].acc, tr[k].gyr);
+            m.euler(&mahonyRef[k * 3]);
+        }
+    }
+    const std::vector<double> *ref = hasRef ? nullptr : &mahonyRef;
+    printf("%zu samples @ %.0f Hz, reference: %s\n", tr.size(), odr,
+           synth ? "synthetic ground truth" : (hasRef ? "CSV" : "double Mahony"));
+    printf("%-14s %10s %10s %10s %10s %10s %10s\n", "filter", "pitch rms", "pitch max", "roll rms", "roll max",
+           "yaw drift", "ns/update");
+
+    static const char *const names[FUSION_COUNT] = {"compl float", "compl Q30", "mahony Q30", "madgwick Q30"};
+    auto print = [](const char *name, const Result &r)
+    {
+        printf("%-14s %10.3f %10.3f %10.3f %10.3f %10.3f %10.1f\n", name, r.rms[0], r.max[0], r.rms[1], r.max[1],
+               r.yawDrift, r.ns);
+    };
+    for (int fi = 0; fi < FUSION_COUNT; fi++)
+    {
+        Fusion f;
+        fusionInit(&f, (FusionFilter)fi, p);
+        Result r = run(
+            tr, odr, ref, [&](const Sample &s)
+            { fusionUpdate(&f, s.acc, s.gyr); },
+            [&](double *e)
+            {
+                int32_t q[3];
+                fusionEuler(&f, q);
+                for (int i = 0; i < 3; i++)
+                    e[i] = q[i] / (double)(1 << FX_DEG_SHIFT);
+            });
+        print(names[fi], r);
+    }
+    for (int mg = 0; mg < 2; mg++)
+    {
+        RefFilter m{mg == 1, p.kp, p.ki, p.beta, 1.0 / odr};
+        Result r = run(
+            tr, odr, ref, [&](const Sample &s)
+            { m.update(s.acc, s.gyr); },
+            [&](double *e)
+            { m.euler(e); });
+        print(mg ? "madgwick dbl" : "mahony dbl", r);
+    }
+    return 0;
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2025 Orazio Franco <robora2025@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * @file mixlut_bench.cpp
+ * @brief Host benchmark of the LUT setpoint shaping of `mixlut.h` against the float path.
+ *
+ * The float path redoes deadzone, expo (or curve) and steer gain at every
+ * call, as the driver does in `driveTank()`; the LUT path reads two tables
+ * built once. Both run on the same random setpoints; the program reports
+ * ns per call, the table build time and the largest difference between the
+ * two outputs (rounding only, at most 1 unit).
+ *
+ * Build and run from the repository root:
+ * @code
+ * g++ -O2 -std=c++17 -Iinclude bench/mixlut_bench.cpp -o mixlut_bench && ./mixlut_bench [deadzone expo steerGain] [curve]
+ * @endcode
+ * Host times only rank the two paths: the ESP32-C3 has no FPU, so the gap
+ * of the float path there is much larger.
+ */
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "mixlut.h"
+
+// percorso float: stessa definizione di mixlut.h, calcolata a ogni chiamata
+static float floatCurve(const MixLutCfg &c, float x)
+{
+    if (c.points)
+    {
+        float x0 = 0, y0 = 0;
+        for (uint8_t i = 0; i <= c.points; i++)
+        {
+            float x1 = i < c.points ? c.curve[i].x / 127.0f : 1.0f;
+            float y1 = i < c.points ? c.curve[i].y / 127.0f : 1.0f;
+            if (x <= x1)
+                return y0 + (y1 - y0) * (x - x0) / (x1 - x0);
+            x0 = x1;
+            y0 = y1;
+        }
+        return 1.0f;
+    }
+    const float e = c.expoPct / 100.0f;
+    return (1.0f - e) * x + e * powf(x, 3.0f);
+}
+
+static float floatShape(const MixLutCfg &c, int16_t v, float gain)
+{
+    const float dz = c.deadzone / 100.0f;
+    float x = fabsf(v / 127.0f);
+    if (x <= dz || dz >= 1.0f)
+        return 0.0f;
+    float y = floatCurve(c, (x - dz) / (1.0f - dz)) * gain;
+    if (y > 1.0f)
+        y = 1.0f;
+    return copysignf(lroundf(y * 127.0f), (float)v);
+}
+
+static void floatApply(const MixLutCfg &c, int16_t throttle, int16_t steer, int16_t out[2])
+{
+    out[0] = (int16_t)floatShape(c, throttle, 1.0f);
+    out[1] = (int16_t)floatShape(c, steer, c.steerGain / 100.0f);
+}
+
+template <typename F>
+static double timeNs(size_t n, F &&f)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+}
+
+int main(int argc, char **argv)
+{
+    MixLutCfg cfg = {};
+    cfg.deadzone = argc > 3 ? (uint8_t)atoi(argv[1]) : 5;
+    cfg.expoPct = argc > 3 ? (uint8_t)atoi(argv[2]) : 40;
+    cfg.steerGain = argc > 3 ? (uint8_t)atoi(argv[3]) : 70;
+    const char *curve = argc == 2 ? argv[1] : (argc > 4 ? argv[4] : "");
+    if (!mixLutParseCurve(curve, &cfg))
+    {
+        fprintf(stderr, "invalid curve \"%s\"\n", curve);
+        return 1;
+    }
+
+    const size_t N = 2000000;
+    std::vector<int16_t> in(N * 2);
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> d(-127, 127);
+    for (auto &v : in)
+        v = (int16_t)d(rng);
+
+    MixLut lut;
+    const int builds = 10000;
+    double buildNs = timeNs(builds, [&]
+                            { for (int i = 0; i < builds; i++) mixLutBuild(&lut, &cfg); });
+
+    int maxDiff = 0;
+    for (int t = -127; t <= 127; t++)
+    {
+        int16_t a[2], b[2];
+        floatApply(cfg, (int16_t)t, (int16_t)t, a);
+        mixLutApply(&lut, (int16_t)t, (int16_t)t, b);
+        maxDiff = std::max(maxDiff, std::max(abs(a[0] - b[0]), abs(a[1] - b[1])));
+    }
+
+    volatile int sink = 0;
+    double floatNs = timeNs(N, [&]
+                            {
+        for (size_t i = 0; i < N; i++)
+        {
+            int16_t o[2];
+            floatApply(cfg, in[i * 2], in[i * 2 + 1], o);
+            sink += o[0] + o[1];
+        } });
+    double lutNs = timeNs(N, [&]
+                          {
+        for (size_t i = 0; i < N; i++)
+        {
+            int16_t o[2];
+            mixLutApply(&lut, in[i * 2], in[i * 2 + 1], o);
+            sink += o[0] + o[1];
+        } });
+
+    printf("deadzone %u%% expo %u%% steerGain %u%% curve %s (%u points)\n", cfg.deadzone, cfg.expoPct, cfg.steerGain,
+           cfg.points ? curve : "-", cfg.points);
+    printf("%-8s %10s\n", "path", "ns/call");
+    printf("%-8s %10.2f\n", "float", floatNs);
+    printf("%-8s %10.2f\n", "lut", lutNs);
+    printf("table build %.0f ns, %zu bytes, max difference %d\n", buildNs, sizeof(MixLut), maxDiff);
+    return 0;
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2025 Orazio Franco <robora2025@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * @file ws_dispatch_bench.cpp
+ * @brief Host microbenchmark of the WebSocket command dispatch.
+ *
+ * Compares the old `std::map<String, handler>` lookup (a temporary key string
+ * is built for every lookup, `std::string` stands in for Arduino `String`)
+ * with the compile-time perfect-hash table of `wscmdtable.h`, for the 10
+ * commands of the firmware.
+ *
+ * Build and run from the repository root:
+ * @code
+ * g++ -O2 -std=c++17 -Iinclude bench/ws_dispatch_bench.cpp -o ws_dispatch_bench && ./ws_dispatch_bench
+ * @endcode
+ */
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <string>
+#include "wscmdtable.h"
+
+typedef void (*Handler)(int);
+static volatile int sink = 0;
+static void h(int v) { sink = sink + v; }
+
+static const char *const names[] = {"hello_robora", "reboot", "config_req", "config_rd", "config_wr",
+                                    "info_req", "move", "function", "reset_memory", "displaymsg"};
+static constexpr size_t NCMD = sizeof(names) / sizeof(names[0]);
+
+static constexpr WsCmdEntry<Handler> list[] = {
+    {"hello_robora", 0, 0, h}, {"reboot", 1, 0, h}, {"config_req", 2, 0, h}, {"config_rd", 3, 0, h},
+    {"config_wr", 4, 0, h}, {"info_req", 5, 0, h}, {"move", 6, 0, h}, {"function", 7, 0, h},
+    {"reset_memory", 8, 0, h}, {"displaymsg", 9, 0, h}};
+static constexpr auto table = wsCmdMakeTable<16>(list);
+static_assert(table.perfect, "table not perfect");
+
+template <typename F>
+static double nsPerCall(F f, size_t iters)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iters; ++i)
+        f(i);
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / iters;
+}
+
+int main()
+{
+    std::map<std::string, Handler> map;
+    for (size_t i = 0; i < NCMD; ++i)
+        map[names[i]] = h;
+
+    const size_t iters = 2000000;
+    printf("%-14s %12s %12s %12s\n", "command", "map ns", "table ns", "id ns");
+    double sumMap = 0, sumTab = 0, sumId = 0;
+    for (size_t c = 0; c < NCMD; ++c)
+    {
+        const char *volatile name = names[c];
+        double m = nsPerCall([&](size_t i)
+                             { auto it = map.find(std::string(name)); if (it != map.end()) it->second((int)i); }, iters);
+        double t = nsPerCall([&](size_t i)
+                             { auto e = table.find(name); if (e) e->handler((int)i); }, iters);
+        volatile uint8_t id = (uint8_t)c;
+        double d = nsPerCall([&](size_t i)
+                             { auto e = table.findId(id); if (e) e->handler((int)i); }, iters);
+        printf("%-14s %12.2f %12.2f %12.2f\n", names[c], m, t, d);
+        sumMap += m;
+        sumTab += t;
+        sumId += d;
+    }
+    printf("%-14s %12.2f %12.2f %12.2f\n", "mean", sumMap / NCMD, sumTab / NCMD, sumId / NCMD);
+    printf("table: %zu buckets, seed %u, %zu bytes, heap 0\n", sizeof(table.bucket), (unsigned)table.seed, sizeof(table));
+    return 0;
+}
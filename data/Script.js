@@ -56,6 +56,7 @@ function go(page) {
   } else {
     stop3D();
   }
+  updateSubscriptions();
 
 }
 $$("[data-goto]").forEach(btn => btn.addEventListener('click', () => go(btn.dataset.goto)));
@@ -65,12 +66,25 @@ $$("[data-goto]").forEach(btn => btn.addEventListener('click', () => go(btn.data
  **********************/
 const wsLabel = $('#wsLabel');
 const wsDot = $('#wsDot');
+const wsRtt = $('#wsRtt');
 
 let ws = null;
 let wsUrl = WS_PATHS[0];
 let reconnectMs = 500;
 let reconnectTimer = null;
 let lastSensorPayload = null; // buffer sensori quando non su pagina robot
+let binProto = 0; // versione protocollo binario annunciata dal firmware in hello_webui (0 = solo JSON)
+let moveSeq = 0; // numero di sequenza dei comandi move (JSON e binari)
+let appliedSeq = 0; // ultimo move applicato dal robot (campo "seq" della telemetria)
+const PING_MS = 1000; // periodo della sonda di latenza
+let pingTimer = null;
+let pingSeq = 0;
+let lastRttUs = 0; // RTT dell'ultimo ping, inviato al robot con il ping successivo
+const SYNC_MS = 2000; // periodo della sincronizzazione degli orologi
+let syncTimer = null;
+let syncSeq = 0;
+let syncPrev = { t1: 0, t4: 0 }; // ultimo scambio completato, chiuso dal robot con il sync successivo
+let clockSync = null; // { off, drift, t2, delay }: stima del robot (off = robot - browser, us)
 let configData = null; // Dati di configurazione caricati dal server
 
 function setWsState(state) {
@@ -83,6 +97,7 @@ function setWsState(state) {
   } else {
     wsLabel.textContent = 'Disconnesso';
     wsDot.className = 'dot';
+    wsRtt.textContent = '';
   }
 }
 
@@ -95,21 +110,37 @@ function connectWS() {
     ws = new WebSocket(wsUrl);
   }
 
+  ws.binaryType = 'arraybuffer';
+  binProto = 0;
+
   ws.addEventListener('open', () => {
     setWsState('ok');
     reconnectMs = 500; // reset backoff
     sendJson({
       CMD: cmd_load_ui,
       client: cmd_client_ui,
-      ver: cmd_ver_ui
+      ver: cmd_ver_ui,
+      ack: 'tele' // niente risposta per ogni move: l'ultimo seq applicato arriva con la telemetria
     });
     // Richiedi i dati di configurazione al server all'apertura della connessione
     sendJson({
       CMD: 'config_req'
     });
+    updateSubscriptions();
+    lastRttUs = 0;
+    clearInterval(pingTimer);
+    pingTimer = setInterval(sendPing, PING_MS);
+    syncPrev = { t1: 0, t4: 0 }; // il robot riparte da zero per ogni connessione
+    clockSync = null;
+    clearInterval(syncTimer);
+    syncTimer = setInterval(sendSync, SYNC_MS);
   });
 
   ws.addEventListener('message', (ev) => {
+    if (ev.data instanceof ArrayBuffer) {
+      handleBinary(ev.data);
+      return;
+    }
     let msg;
     try {
       msg = JSON.parse(ev.data);
@@ -130,6 +161,10 @@ function connectWS() {
 
 function scheduleReconnect() {
   setWsState('down');
+  clearInterval(pingTimer);
+  pingTimer = null;
+  clearInterval(syncTimer);
+  syncTimer = null;
   if (reconnectTimer) return;
   reconnectTimer = setTimeout(() => {
     reconnectTimer = null;
@@ -146,12 +181,310 @@ function sendJson(obj) {
   }
 }
 
+function sendBinary(buf) {
+  if (ws && ws.readyState === 1) {
+    ws.send(buf);
+  }
+}
+
+/**********************
+ * PROTOCOLLO BINARIO (vedi wsproto.h)
+ **********************/
+const BIN_OP_MOVE = 0x01;
+const BIN_OP_PING = 0x03;
+const BIN_OP_SYNC = 0x04;
+const BIN_OP_ACK = 0x81;
+const BIN_OP_PONG = 0x83;
+const BIN_OP_SENSOR = 0x84;
+const BIN_OP_SENSOR_AGG = 0x85;
+const BIN_OP_SENSOR_DELTA = 0x86;
+const BIN_OP_ATTITUDE = 0x87;
+const BIN_OP_SENSOR_HIST = 0x88;
+const BIN_OP_SYNC_REPLY = 0x89;
+const ALARM_TILT = 0x01, ALARM_BATT = 0x02;
+const BIN_FLAG_ACK = 0x01;
+
+function nextMoveSeq() {
+  moveSeq = (moveSeq + 1) & 0xFFFF;
+  return moveSeq;
+}
+
+function buildBinMove(throttle, steer, flags = 0) {
+  const buf = new ArrayBuffer(8);
+  const dv = new DataView(buf);
+  nextMoveSeq();
+  dv.setUint8(0, BIN_OP_MOVE);
+  dv.setUint8(1, binProto);
+  dv.setUint16(2, moveSeq, true);
+  dv.setInt8(4, throttle);
+  dv.setInt8(5, steer);
+  dv.setUint8(6, flags);
+  dv.setUint8(7, 0);
+  return buf;
+}
+
+/**********************
+ * SOTTOSCRIZIONI AI TOPIC (sub/unsub)
+ **********************/
+// Topic ricevuti da ogni pagina: le altre pagine non ricevono broadcast
+const ALL_TOPICS = ['sensor', 'ota', 'display', 'log', 'attitude'];
+const PAGE_TOPICS = {
+  robot: ['sensor'],
+  model3d: ['sensor', 'attitude'], // 'attitude' (quaternione binario) ha la precedenza sugli angoli di 'sensor'
+  ota: ['ota'],
+  display: ['display'],
+};
+
+// Frequenza della telemetria chiesta da questo client (0 = periodo di default del robot)
+let teleHz = Number(localStorage.getItem('teleHz')) || 0;
+
+function updateSubscriptions() {
+  const want = PAGE_TOPICS[currentPage] || [];
+  sendJson({ CMD: 'unsub', topics: ALL_TOPICS.filter(t => !want.includes(t)) });
+  // con il protocollo binario la telemetria arriva come frame WsBinSensor (24 byte)
+  if (want.length) sendJson({
+    CMD: 'sub', topics: want, hz: { sensor: teleHz },
+    fmt: binProto >= 1 ? { sensor: 'bin' } : undefined
+  });
+}
+
+function setupTeleRate() {
+  const sel = $('#teleHz');
+  if (!sel) return;
+  sel.value = String(teleHz);
+  sel.addEventListener('change', () => {
+    teleHz = Number(sel.value) || 0;
+    localStorage.setItem('teleHz', String(teleHz));
+    sendJson({ CMD: 'sub', topics: [], hz: { sensor: teleHz } });
+  });
+}
+
+/**********************
+ * SONDA DI LATENZA (ping/pong)
+ **********************/
+// Timestamp locale in microsecondi, troncato a 32 bit come quelli del robot
+function nowUs() {
+  return Math.round(performance.now() * 1000) >>> 0;
+}
+
+function sendPing() {
+  pingSeq = (pingSeq + 1) & 0xFFFF;
+  if (binProto >= 1) {
+    const buf = new ArrayBuffer(12);
+    const dv = new DataView(buf);
+    dv.setUint8(0, BIN_OP_PING);
+    dv.setUint8(1, binProto);
+    dv.setUint16(2, pingSeq, true);
+    dv.setUint32(4, nowUs(), true);
+    dv.setUint32(8, lastRttUs, true);
+    sendBinary(buf);
+  } else if (ws && ws.readyState === 1) {
+    ws.send(JSON.stringify({ CMD: 'ping', t: nowUs(), rtt: lastRttUs })); // senza log: parte ogni secondo
+  }
+}
+
+// p: { t, rx, disp, apply, lag, aseq } (tempi del robot in us, modulo 2^32)
+function onPong(p) {
+  lastRttUs = (nowUs() - p.t) >>> 0;
+  wsRtt.textContent = ` · ${(lastRttUs / 1000).toFixed(1)} ms`;
+  wsRtt.title = `RTT ${lastRttUs} µs, dispatch ${((p.disp - p.rx) >>> 0)} µs, ` +
+    `attesa motori ${p.lag} µs (move #${p.aseq})` + (clockSync ?
+      `, orologio ${(clockSync.off / 1000).toFixed(1)} ms, deriva ${(clockSync.drift / 1000).toFixed(1)} ppm` : '');
+}
+
+/**********************
+ * SINCRONIZZAZIONE OROLOGI (sync, stile NTP)
+ **********************/
+// Tempo del browser in microsecondi dall'epoch Unix: confrontabile tra pagine e con altri log
+function epochUs() {
+  return Math.round((performance.timeOrigin + performance.now()) * 1000);
+}
+
+function sendSync() {
+  syncSeq = (syncSeq + 1) & 0xFFFF;
+  const t1 = epochUs();
+  if (binProto >= 1) {
+    const buf = new ArrayBuffer(28);
+    const dv = new DataView(buf);
+    dv.setUint8(0, BIN_OP_SYNC);
+    dv.setUint8(1, binProto);
+    dv.setUint16(2, syncSeq, true);
+    dv.setBigInt64(4, BigInt(t1), true);
+    dv.setBigInt64(12, BigInt(syncPrev.t1), true);
+    dv.setBigInt64(20, BigInt(syncPrev.t4), true);
+    sendBinary(buf);
+  } else if (ws && ws.readyState === 1) {
+    ws.send(JSON.stringify({ CMD: 'sync', t1, pt1: syncPrev.t1, pt4: syncPrev.t4 })); // senza log: periodico
+  }
+}
+
+// r: { t1, t2, t3, off, drift, delay } (t2/t3 in us di esp_timer, off in us, drift in ppb)
+function onSync(r) {
+  syncPrev = { t1: r.t1, t4: epochUs() };
+  if (!r.delay) return; // nessuno scambio ancora chiuso
+  clockSync = { off: r.off, drift: r.drift, t2: r.t2, delay: r.delay };
+}
+
+// Istante del browser (ms dall'epoch) di un millis() del robot, null senza sincronizzazione
+function robotMsToEpochMs(ms) {
+  if (!clockSync) return null;
+  const robotUs = ms * 1000;
+  return (robotUs - clockSync.off - (robotUs - clockSync.t2) * clockSync.drift / 1e9) / 1000;
+}
+
+function handleBinary(buf) {
+  if (buf.byteLength < 4) return;
+  const dv = new DataView(buf);
+  switch (dv.getUint8(0)) {
+    case BIN_OP_ACK:
+      if (buf.byteLength >= 6 && dv.getUint8(5) !== 0) console.warn('WS bin NACK seq', dv.getUint16(2, true));
+      break;
+    case BIN_OP_PONG:
+      if (buf.byteLength >= 28) onPong({
+        t: dv.getUint32(4, true), rx: dv.getUint32(8, true), disp: dv.getUint32(12, true),
+        apply: dv.getUint32(16, true), lag: dv.getUint32(20, true), aseq: dv.getUint16(24, true)
+      });
+      break;
+    case BIN_OP_SYNC_REPLY:
+      if (buf.byteLength >= 44) onSync({
+        t1: Number(dv.getBigInt64(4, true)), t2: Number(dv.getBigInt64(12, true)),
+        t3: Number(dv.getBigInt64(20, true)), off: Number(dv.getBigInt64(28, true)),
+        drift: dv.getInt32(36, true), delay: dv.getUint32(40, true)
+      });
+      break;
+    case BIN_OP_SENSOR:
+      if (buf.byteLength >= 24) onSensor(decodeBinSensor(dv));
+      break;
+    case BIN_OP_SENSOR_DELTA:
+      if (buf.byteLength >= 12) onSensor(decodeBinSensorDelta(dv));
+      break;
+    case BIN_OP_ATTITUDE:
+      if (buf.byteLength >= 16) onAttitude(dv);
+      break;
+    case BIN_OP_SENSOR_AGG:
+      if (buf.byteLength >= 8) updateSensorAgg(decodeBinSensorAgg(dv));
+      break;
+    case BIN_OP_SENSOR_HIST:
+      if (buf.byteLength >= 12) onSensorHistory(decodeBinSensorHist(dv));
+      break;
+  }
+}
+
+// Converte un frame WsBinSensor (virgola fissa) nello stesso oggetto del JSON 'sensor'
+function decodeBinSensor(dv) {
+  return {
+    CMD: 'sensor',
+    sens0: (dv.getInt16(8, true) / 100).toFixed(2),
+    sens1: (dv.getInt16(10, true) / 100).toFixed(2),
+    sens2: (dv.getInt16(12, true) / 100).toFixed(2),
+    sens3: (dv.getInt16(14, true) / 100).toFixed(2),
+    sens4: (dv.getUint16(16, true) / 1000).toFixed(2),
+    sens5: (dv.getInt16(20, true) / 100).toFixed(2),
+    sens6: (dv.getInt16(22, true) / 100).toFixed(2),
+    sens7: String(dv.getUint32(4, true)),
+    seq: dv.getUint16(18, true),
+  };
+}
+
+// Converte un frame WsBinSensorDelta: solo i canali presenti in 'mask'
+function decodeBinSensorDelta(dv) {
+  const msg = { CMD: 'sensor', delta: 1, sens7: String(dv.getUint32(4, true)), seq: dv.getUint16(10, true) };
+  const mask = dv.getUint8(8);
+  const alarm = dv.getUint8(9);
+  if (alarm) msg.alarm = alarm;
+  let off = 12;
+  for (let i = 0; i < 5 && off + 2 <= dv.byteLength; i++) {
+    if (!(mask & (1 << i))) continue;
+    msg[`sens${i}`] = i === 4 ? (dv.getUint16(off, true) / 1000).toFixed(2) : (dv.getInt16(off, true) / 100).toFixed(2);
+    off += 2;
+  }
+  return msg;
+}
+
+// Converte un frame WsBinSensorAgg nello stesso oggetto del campo 'agg' del JSON
+function decodeBinSensorAgg(dv) {
+  const agg = { n: dv.getUint16(4, true) };
+  const mask = dv.getUint8(6);
+  let off = 8;
+  for (let i = 0; i < 8 && off + 8 <= dv.byteLength; i++) {
+    if (!(mask & (1 << i))) continue;
+    agg[`sens${i}`] = [0, 2, 4, 6].map(k => dv.getInt16(off + k, true) / 100);
+    off += 8;
+  }
+  return agg;
+}
+
+// Converte un frame WsBinSensorHist nella lista dei campioni, dal più vecchio
+function decodeBinSensorHist(dv) {
+  const count = dv.getUint16(8, true);
+  const size = dv.getUint8(10);
+  const recs = [];
+  for (let i = 0, off = 12; i < count && size >= 14 && off + size <= dv.byteLength; i++, off += size) {
+    recs.push({
+      ms: dv.getUint32(off, true),
+      sens0: dv.getInt16(off + 4, true) / 100,
+      sens1: dv.getInt16(off + 6, true) / 100,
+      sens2: dv.getInt16(off + 8, true) / 100,
+      sens3: dv.getInt16(off + 10, true) / 100,
+      sens4: dv.getUint16(off + 12, true) / 1000,
+    });
+  }
+  return recs;
+}
+
+// Storico della telemetria: riempito dal frame 0x88 all'iscrizione, poi dai campioni live
+const SENSOR_HISTORY_MAX = 1200;
+let sensorHistory = [];
+function pushSensorHistory(rec) {
+  const last = sensorHistory[sensorHistory.length - 1];
+  if (last && ((rec.ms - last.ms) | 0) <= 0) return; // già presente (riconnessione)
+  rec.t = robotMsToEpochMs(rec.ms); // stesso asse temporale degli input della UI
+  sensorHistory.push(rec);
+  if (sensorHistory.length > SENSOR_HISTORY_MAX) sensorHistory.splice(0, sensorHistory.length - SENSOR_HISTORY_MAX);
+}
+
+function onSensorHistory(recs) {
+  if (!recs.length) return;
+  sensorHistory = [];
+  recs.forEach(pushSensorHistory);
+  // i campi mostrano subito l'ultimo campione, senza aspettare il prossimo invio
+  const last = recs[recs.length - 1];
+  const vals = { sens7: String(last.ms) };
+  for (let i = 0; i < 5; i++) vals[`sens${i}`] = last[`sens${i}`].toFixed(2);
+  onSensor(vals);
+}
+
+// Ultimi valori ricevuti: i messaggi 'delta' portano solo i canali cambiati
+let sensorState = {};
+function onSensor(msg) {
+  if ('seq' in msg) appliedSeq = msg.seq;
+  if (msg.agg) updateSensorAgg(msg.agg);
+  updateSensorAlarm(msg.alarm || 0);
+  const { agg, alarm, delta, ...vals } = msg;
+  Object.assign(sensorState, vals);
+  msg = Object.assign({}, sensorState);
+  if (msg.sens7 !== undefined) {
+    const rec = { ms: Number(msg.sens7) >>> 0 };
+    for (let i = 0; i < 5; i++) rec[`sens${i}`] = Number(msg[`sens${i}`]);
+    pushSensorHistory(rec);
+  }
+  update3dGyro(msg);
+  if (currentPage === 'robot') updateSensors(msg);
+  else lastSensorPayload = msg;
+}
+
 /**********************
  * HANDLER MESSAGGI WS
  **********************/
 function handleMessage(msg) {
+  if (msg.CMD === 'pong') { onPong(msg); return; } // senza log: arriva ogni secondo
+  if (msg.CMD === 'sync') { onSync(msg); return; }
   console.log('WS <<', msg);
   switch (msg.CMD) {
+    case 'hello_webui':
+      binProto = Number(msg.bin) || 0;
+      updateSubscriptions(); // ora il formato binario della telemetria è noto
+      break;
     case 'config_req':
       configData = msg;
       buildConfig();
@@ -162,13 +495,14 @@ function handleMessage(msg) {
       updateParamsFromMsg(msg);
       break;
     case 'sensor':
-      update3dGyro(msg);
-      if (currentPage === 'robot') updateSensors(msg);
-      else lastSensorPayload = msg;
+      onSensor(msg);
       break;
     case 'info':
       updateInfo(msg);
       break;
+    case 'blackbox':
+      updateBlackbox(msg);
+      break;
     case 'ota':
       handleOtaWs(msg);
       break;
@@ -291,7 +625,7 @@ function updateParamsFromMsg(msg) {
 /**********************
  * PAGINA INFO
  **********************/
-const INFO_NAMES = ['info1', 'info2', 'info3', 'info4', 'info5', 'info6', 'info7', 'info8'];
+const INFO_NAMES = ['info1', 'info2', 'info3', 'info4', 'info5', 'info6', 'info7', 'info8', 'info9', 'info10', 'info11', 'info12', 'info13'];
 function buildInfo() {
   const wrap = $('#infoContainer');
   wrap.innerHTML = '';
@@ -312,9 +646,23 @@ function buildInfo() {
     wrap.append(card);
   });
   $('#refreshInfo').addEventListener('click', requestInfo);
+  // il firmware apre/chiude il file in background: lo stato si rilegge poco dopo
+  $('#bbRec').addEventListener('click', () => { sendJson({ CMD: 'blackbox', rec: 1 }); setTimeout(requestInfo, 500); });
+  $('#bbStop').addEventListener('click', () => { sendJson({ CMD: 'blackbox', rec: 0 }); setTimeout(requestInfo, 500); });
 }
 function requestInfo() {
   sendJson({ CMD: 'info_req' });
+  sendJson({ CMD: 'blackbox' });
+}
+
+// Stato della scatola nera (risposta al comando 'blackbox')
+function updateBlackbox(msg) {
+  const el = $('#bbState');
+  if (!el) return;
+  if (msg.error) { el.textContent = 'Disattivata (bbKB = 0)'; return; }
+  const state = msg.rec ? 'In registrazione' : (msg.full ? 'Completa (file pieno)' : 'Ferma');
+  el.textContent = `${state} · ${(msg.bytes / 1024).toFixed(0)}/${(msg.cap / 1024).toFixed(0)} KB · ` +
+    `${msg.records} record · ${msg.dropped} persi`;
 }
 function updateInfo(msg) {
   INFO_NAMES.forEach(n => {
@@ -346,6 +694,23 @@ function buildSensors() {
     grid.append(wrap);
   });
 }
+// Aggregati della finestra (min/max/media/RMS) come tooltip dei campi sensore
+function updateSensorAgg(agg) {
+  SENSOR_NAMES.forEach(n => {
+    const el = document.getElementById(`sns_${n}`);
+    if (!el) return;
+    const a = agg[n];
+    el.title = a ? `min ${a[0].toFixed(2)} max ${a[1].toFixed(2)} media ${a[2].toFixed(2)} RMS ${a[3].toFixed(2)} (${agg.n} campioni)` : '';
+  });
+}
+// Evidenzia i campi dei canali in allarme (inclinazione: sens0/1, batteria: sens4)
+function updateSensorAlarm(alarm) {
+  const on = { sens0: alarm & ALARM_TILT, sens1: alarm & ALARM_TILT, sens4: alarm & ALARM_BATT };
+  Object.keys(on).forEach(n => {
+    const el = document.getElementById(`sns_${n}`);
+    if (el) el.classList.toggle('alarm', !!on[n]);
+  });
+}
 function updateSensors(msg) {
   SENSOR_NAMES.forEach(n => {
     if (n in msg) {
@@ -389,6 +754,8 @@ let joyVec = { x: 0, y: 0 };
 let activePointerId = null;
 let sendMode = $('#sendMode').value;
 let moveTimer = null;
+const MOVE_KEEPALIVE_MS = 100; // in modalità "su cambio" il vettore non nullo viene ripetuto: il robot ferma i motori dopo "deadline" senza move
+let lastMoveMs = 0;
 
 function joyInit() {
   positionKnob(0, 0);
@@ -400,6 +767,10 @@ function joyInit() {
   document.addEventListener('keydown', onKey);
   document.addEventListener('keyup', onKeyUp);
 
+  setInterval(() => {
+    if (sendMode === 'onchange' && (joyVec.x || joyVec.y) && performance.now() - lastMoveMs >= MOVE_KEEPALIVE_MS) sendMove();
+  }, MOVE_KEEPALIVE_MS / 2);
+
   $('#sendMode').addEventListener('change', (e) => {
     sendMode = e.target.value;
     if (sendMode === 'interval') startMoveLoopIfNeeded();
@@ -488,7 +859,9 @@ function stopMoveLoop() {
 }
 
 function sendMove() {
-  sendJson({ CMD: 'move', x: String(joyVec.x), y: String(joyVec.y) });
+  lastMoveMs = performance.now();
+  if (binProto >= 1) sendBinary(buildBinMove(joyVec.y, joyVec.x));
+  else sendJson({ CMD: 'move', x: String(joyVec.x), y: String(joyVec.y), seq: nextMoveSeq() });
 }
 
 // Tastiera: frecce
@@ -875,6 +1248,7 @@ function start3D() {
   document.addEventListener('visibilitychange', () => { if (!document.hidden) invalidate3D(); });
   renderer.setAnimationLoop(() => {
     if (document.hidden) return;     // pausa se tab non visibile
+    if (attInterpolate()) needsRender = true;
     if (!needsRender) return;        // render solo quando serve
     renderer.render(scene, camera);
     needsRender = false;
@@ -1012,8 +1386,51 @@ function tryReadEulerRaw(msg) {
   return null;
 }
 
+// ===== Stream quaternione (topic 'attitude') =====
+// I campioni hanno il timestamp del robot: il visualizzatore disegna con un
+// ritardo fisso ATT_DELAY_MS e interpola (slerp) tra i due campioni che
+// racchiudono l'istante, così il moto è fluido anche con il jitter di rete.
+const ATT_DELAY_MS = 60;
+const ATT_TIMEOUT_MS = 500; // oltre, si torna agli angoli di 'sensor'
+const attBuf = [];          // { t: ms locali, q: THREE.Quaternion }, in ordine di tempo
+let attOffsetMs = null;     // ms locali - ms robot (minimo osservato = latenza minima)
+let attRobotMs = 0, attLastUs = null, attLastRx = 0;
+
+function onAttitude(dv) {
+  const tUs = dv.getUint32(4, true);
+  // tempo robot continuo (i microsecondi a 32 bit ripartono ogni ~71 minuti)
+  attRobotMs = attLastUs === null ? tUs / 1000 : attRobotMs + ((tUs - attLastUs) >>> 0) / 1000;
+  attLastUs = tUs;
+  const now = performance.now();
+  const off = now - attRobotMs;
+  if (attOffsetMs === null || off < attOffsetMs || now - attLastRx > ATT_TIMEOUT_MS) attOffsetMs = off;
+  attLastRx = now;
+  const [w, x, y, z] = [0, 1, 2, 3].map(i => dv.getInt16(8 + i * 2, true) / 16384);
+  // stessi assi della mappa Euler: pitch (Y robot) -> X, yaw (Z) -> Y, roll (X, invertito) -> Z
+  const q = new THREE.Quaternion(y, z, -x, w).normalize();
+  attBuf.push({ t: attRobotMs + attOffsetMs, q });
+  while (attBuf.length > 32) attBuf.shift();
+  invalidate3D();
+}
+
+function attStreamActive() {
+  return attBuf.length > 0 && performance.now() - attLastRx < ATT_TIMEOUT_MS;
+}
+
+// Chiamata a ogni frame del loop di render: true se l'assetto è cambiato
+function attInterpolate() {
+  if (!robot || !attStreamActive()) return false;
+  const t = performance.now() - ATT_DELAY_MS;
+  while (attBuf.length > 2 && attBuf[1].t <= t) attBuf.shift();
+  const a = attBuf[0], b = attBuf[1];
+  if (!b || t <= a.t) robot.quaternion.copy(a.q);
+  else robot.quaternion.copy(a.q).slerp(b.q, Math.min(1, (t - a.t) / (b.t - a.t || 1)));
+  return true;
+}
+
 function update3dGyro(msg) {
   if (!robot) return;
+  if (attStreamActive()) return; // il quaternione interpolato ha la precedenza
 
   //Euler esplicito (pitch/yaw/roll) oppure Euler raw (sens0/1/2, x/y/z)
   const euler = tryReadEulerExplicit(msg) || tryReadEulerRaw(msg);
@@ -1208,6 +1625,7 @@ function boot() {
   buildOTA();
   connectWS();
   setupModelColorUI();
+  setupTeleRate();
 }
 window.addEventListener('load', () => {
   boot();
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2025 Orazio Franco <robora2025@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * @file adccont.h
+ * @brief Continuous (DMA) ADC sampling of the analog inputs.
+ *
+ * The ADC converts the pins listed in @ref ADC_CONT_PINS in the background
+ * with the continuous driver of the Arduino core: the hardware averages
+ * @ref ADC_CONT_CONV_PER_PIN conversions per frame, a low priority task
+ * collects the frames and filters them with an integer moving average of
+ * @ref ADC_CONT_AVG_LEN frames. The filtered values are published in atomic
+ * variables, so readers never block and never start a conversion.
+ */
+#pragma once
+#include <Arduino.h>
+#include "all_define.h"
+
+/**
+ * @enum AdcContChannel
+ * @brief Index of a pin in @ref ADC_CONT_PINS.
+ */
+enum AdcContChannel : uint8_t
+{
+  ADC_CH_BATTERY = 0, ///< Battery divider (@ref PIN_BATTERY_VOLTAGE).
+};
+
+/**
+ * @brief Starts the continuous sampling.
+ *
+ * Safe to call more than once: the driver and the task are started only the
+ * first time.
+ * @return true if the sampling is running.
+ */
+bool adcContInit();
+
+/**
+ * @brief Gets the filtered voltage at an ADC pin.
+ *
+ * @param ch The channel (index in @ref ADC_CONT_PINS).
+ * @return The calibrated voltage at the pin in millivolts, 0 before the first frame.
+ */
+uint32_t adcContGetMv(uint8_t ch);
+
+/**
+ * @brief Gets the battery voltage.
+ *
+ * @return The battery voltage in volts (pin voltage times @ref VOLTAGE_DIVIDER_RATIO).
+ */
+float adcContGetBattery();
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2025 Orazio Franco <robora2025@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * @file aggstat.h
+ * @brief Streaming min/max/mean/RMS of a signal (Welford update).
+ *
+ * The mean and the sum of squared deviations are updated with Welford's
+ * algorithm, which is numerically stable in single precision even for long
+ * windows of nearly constant values; the RMS is derived from them as
+ * `sqrt(mean^2 + M2/n)`. Header only, no allocation.
+ */
+#pragma once
+#include <stdint.h>
+#include <math.h>
+
+/**
+ * @struct AggStat
+ * @brief Aggregate of a window of samples.
+ */
+typedef struct sAggStat
+{
+    uint32_t n = 0;  ///< @brief Number of samples.
+    float min = 0;   ///< @brief Smallest sample.
+    float max = 0;   ///< @brief Largest sample.
+    float mean = 0;  ///< @brief Running mean.
+    float m2 = 0;    ///< @brief Sum of squared deviations from the mean.
+} AggStat;
+
+/**
+ * @brief Starts a new window.
+ * @param a The aggregate.
+ */
+static inline void aggStatReset(AggStat *a)
+{
+    *a = AggStat();
+}
+
+/**
+ * @brief Adds a sample.
+ * @param a The aggregate.
+ * @param x The sample.
+ */
+static inline void aggStatAdd(AggStat *a, float x)
+{
+    if (a->n == 0)
+    {
+        a->min = a->max = x;
+    }
+    else
+    {
+        if (x < a->min)
+            a->min = x;
+        if (x > a->max)
+            a->max = x;
+    }
+    a->n++;
+    float d = x - a->mean;
+    a->mean += d / a->n;
+    a->m2 += d * (x - a->mean);
+}
+
+/**
+ * @brief Root mean square of the window.
+ * @param a The aggregate.
+ * @return The RMS, 0 for an empty window.
+ */
+static inline float aggStatRms(const AggStat *a)
+{
+    return a->n ? sqrtf(a->mean * a->mean + a->m2 / a->n) : 0.0f;
+}
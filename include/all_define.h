@@ -50,12 +50,19 @@
 #define MAX_ADC_VOLTAGE 2.5       // Maximum voltage measurable by the ADC with 11dB attenuation (circa 2.5V)
 #define VOLTAGE_DIVIDER_RATIO 5.0 // Voltage divider ratio (es. 5.0 for 40kOhm and 10kOhm)
 #define PIN_BATTERY_VOLTAGE 4
+#define ADC_CONT_PINS {PIN_BATTERY_VOLTAGE} // continuous ADC pins, order of AdcContChannel (ADC1: GPIO0..4 on the C3)
+#define ADC_CONT_FREQ_HZ 1000               // continuous ADC sampling frequency (C3 min 611 Hz)
+#define ADC_CONT_CONV_PER_PIN 16            // conversions averaged by the driver in each frame
+#define ADC_CONT_AVG_LEN 8                  // frames in the moving average
+#define ADC_CONT_TASK_STACK 2048
+#define ADC_CONT_TASK_PRIO 2
 
 /*---"config.h" --*/
 #define CONFIG_PARTITION_USE_SPIFFS
 
 #define CONFIG_STRING_LEN 64
 #define CONFIG_IPADD_LEN 16
+#define CONFIG_MAX_LISTENERS 4 // change callbacks (configOnChange)
 #define MOTO_DEFAULT_MAXVEL 100
 #define MOTO_DEFAULT_DEADZONE 5
 #define MOTO_DEFAULT_EXPOPCT 0
@@ -66,6 +73,14 @@
 #define MOTO_DEFAULT_INVERTB 0
 #define MOTO_DEFAULT_TANKINVTHR 0
 #define MOTO_DEFAULT_TANKINVSTR 1
+#define MOTO_DEFAULT_CTRLHZ 500 // motor control task rate (Hz)
+#define MOTO_DEFAULT_ACCEL 500  // slew limit away from zero (setpoint units/s, 0 = off): 0..127 in ~0.25 s
+#define MOTO_DEFAULT_DECEL 1000 // slew limit towards zero (setpoint units/s, 0 = off)
+#define MOTO_DEFAULT_INTERP 1   // interpolate between move setpoints
+#define MOTO_DEFAULT_DEADLINE 300 // move watchdog (ms, 0 = off): without a new move the motors ramp to zero
+#define MOTO_DEFAULT_BRAKE 0      // after the watchdog ramp: 0 = coast, 1 = brake
+#define MOTO_DEFAULT_LUTMIX 0     // integer LUT shaping (deadzone, expo/curve, steer gain) instead of the driver float math
+#define MOTO_DEFAULT_CURVE ""     // curve control points "x:y,..." (0..127), empty = expo
 
 #define WIFI_DEFAULT_AP_STA 0
 #define WIFI_DEFAULT_RETRAY 0
@@ -79,6 +94,20 @@
 
 #define TELE_DEFAULT_ENABLE 0
 #define TELE_DEFAULT_REFRESH 250
+#define TELE_DEFAULT_FIFO 0
+#define TELE_DEFAULT_ODR 100
+#define TELE_DEFAULT_AGGMASK 0
+#define TELE_DEFAULT_DELTA 0
+#define TELE_DEFAULT_KEYMS 5000
+#define TELE_DEFAULT_DBANGLE 20   // 0.01 deg
+#define TELE_DEFAULT_DBTEMP 20    // 0.01 C
+#define TELE_DEFAULT_DBBATT 50    // mV
+#define TELE_DEFAULT_ALRTILT 0    // deg, 0 = off
+#define TELE_DEFAULT_ALRBATT 0    // mV, 0 = off
+#define TELE_DEFAULT_FILTER 0     // FusionFilter, 0 = complementary float
+#define TELE_DEFAULT_ATTHZ 50     // attitude quaternion stream rate (Hz), 0 = off
+#define TELE_DEFAULT_HISTKB 4     // telemetry history ring budget (KB), 0 = off
+#define TELE_DEFAULT_BBKB 128     // flight recorder file size (KB), 0 = off
 
 /*---"net.h" --*/
 
@@ -88,15 +117,53 @@
 #define IN1B_PIN 2
 #define IN2B_PIN 3
 #define OUTSTOP_PIN 10 // NOT USED
+#define MOTORS_TASK_STACK 3072
+#define MOTORS_TASK_PRIO 6     // above the IMU task (5): the outputs are never late because of a sensor read
 /*---"ota.h" --*/
 #define OTA_REQUEST_RESET 700
 
 /*---"websocket.h" --*/
 #define WS_REQUEST_RESET 500
 #define WS_MAX_CLIENTS 4
-#define WS_MAX_PAYLOAD (8 * 1024)
+#define WS_MAX_PAYLOAD (2 * 1024) // per-client slab for fragmented messages
+#define WS_JSON_ARENA_SIZE 2048 // per-client JSON arena, one message and its replies
+#define WS_JSON_TX_SIZE 512     // reusable serialization buffer of WsSendJson
+#define WS_OUTQ_SLOT_SIZE 256   // max size of a queued outbound message, larger ones are sent directly
+#define WS_OUTQ_CTRL_DEPTH 4    // per-client control (ack) queue depth
+#define WS_OUTQ_EVENT_DEPTH 4   // per-client event (OTA, async) queue depth
+#define WS_OUTQ_TELE_DEPTH 4    // per-client telemetry slots, one per frame kind (sensor, aggregates, attitude...)
+#define WS_OUTQ_BURST 8         // max messages sent to one client per websocketTick()
+#define WS_RATE_MAX_HZ 50       // fastest per-client rate of a paced topic (telemetry)
 
 /*---"telemetry.h" --*/
+#define TELE_JSON_MAX 448          // max size of the JSON sensor message (with all the aggregates)
+#define TELE_AGG_CHANNELS 4        // aggregated channels: sens0..sens3 (pitch, roll, yaw, temperature)
+#define TELE_DELTA_CHANNELS 5      // change-detected channels: sens0..sens4 (pitch, roll, yaw, temperature, battery)
+#define IMU_SAMPLE_PERIOD_US 10000 // IMU sampling period of the acquisition task (100 Hz)
+#define IMU_RING_SIZE 64           // timestamped IMU samples buffered between the task and telemetryTick(), power of two
+#define IMU_TASK_STACK 3072
+#define IMU_TASK_PRIO 5            // above loop() (1), so display flushes do not delay the sampling
+#define IMU_I2C_ADDR 0x68          // ICM42670 address (AD0 low), used by the FIFO mode
+#define IMU_FIFO_DRAIN_US 20000    // FIFO drain period of the acquisition task
+#define IMU_FIFO_BURST 128         // bytes per FIFO burst read (Wire buffer), 8 packets
+#define IMU_FIFO_MAX_BATCH 64      // max samples decoded per drain, the rest waits in the FIFO
+#define IMU_FIFO_ACC_LSB_G 8192.0f // accel +-4 g
+#define IMU_FIFO_GYR_LSB_DPS 65.5f // gyro +-500 dps
+
+/*---"attitude.h" --*/
+#define ATTITUDE_COMPL_K 0.98f // complementary filter gyro weight
+#define ATTITUDE_KP 1.0f       // proportional gain of the complementary/Mahony quaternion filters (1/s)
+#define ATTITUDE_KI 0.05f      // Mahony integral gain, gyro bias (1/s^2)
+#define ATTITUDE_BETA 0.05f    // Madgwick gain (rad/s)
+
+/*---"blackbox.h" --*/
+#define BLACKBOX_FILE "/blackbox.bin"  // flight recorder log on the filesystem partition
+#define BLACKBOX_BLOCK_SIZE 4096       // bytes per append, one flash sector
+#define BLACKBOX_RING_SIZE 128         // samples buffered between telemetryTick() and the writer task, power of two
+#define BLACKBOX_FLUSH_MS 100          // writer task wake-up period
+#define BLACKBOX_FS_MARGIN (16 * 1024) // space always left free on the partition
+#define BLACKBOX_TASK_STACK 3072
+#define BLACKBOX_TASK_PRIO 1           // same as loop(): flash writes never preempt the control path
 
 /*---"connection.h" --*/
 
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2025 Orazio Franco <robora2025@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * @file attitude.h
+ * @brief Attitude estimation from the IMU FIFO samples.
+ *
+ * Runs one of the filters of `fusion.h`, selected by the telemetry parameter
+ * "filter": the original complementary filter on float Euler angles, or the
+ * fixed-point complementary, Mahony and Madgwick quaternion filters. The
+ * yaw is the integrated gyroscope rate only (no magnetometer on the
+ * ICM42670). The CPU cycles spent per update are measured.
+ *
+ * The filter state is not protected: update and read it from one task (the
+ * IMU acquisition task).
+ */
+#pragma once
+#include <Arduino.h>
+#include "all_define.h"
+#include "imufifo.h"
+#include "fusion.h"
+
+/**
+ * @struct Attitude
+ * @brief Estimated attitude.
+ */
+typedef struct sAttitude
+{
+  float pitch = 0;                   ///< @brief Rotation around Y in degrees, positive nose up.
+  float roll = 0;                    ///< @brief Rotation around X in degrees.
+  float yaw = 0;                     ///< @brief Rotation around Z in degrees, -180..180.
+  int32_t q[4] = {FX_ONE, 0, 0, 0};  ///< @brief Quaternion w, x, y, z (Q30).
+} Attitude;
+
+/**
+ * @struct AttitudeStats
+ * @brief Cost of the selected filter.
+ */
+typedef struct sAttitudeStats
+{
+  FusionFilter filter = FUSION_COMPL_F; ///< @brief Selected filter.
+  uint32_t updates = 0;                 ///< @brief Samples processed since the reset.
+  uint32_t cyclesAvg = 0;               ///< @brief Mean CPU cycles per update (filter + Euler angles).
+  uint32_t cyclesMax = 0;               ///< @brief Worst case CPU cycles per update.
+} AttitudeStats;
+
+/**
+ * @brief Selects the filter and resets it: the next sample initializes the estimate from the accelerometer.
+ *
+ * @param filter The filter ("filter" parameter).
+ * @param odrHz The FIFO sample rate.
+ */
+void attitudeReset(FusionFilter filter, uint16_t odrHz);
+
+/**
+ * @brief Feeds one FIFO sample to the filter.
+ *
+ * @param s The sample, taken at the rate given to `attitudeReset()`.
+ */
+void attitudeUpdate(const ImuRaw &s);
+
+/**
+ * @brief Gets the current estimate.
+ *
+ * @return The attitude.
+ */
+Attitude attitudeGet();
+
+/**
+ * @brief Gets the cost of the filter (safe from any task).
+ *
+ * @return A copy of the statistics.
+ */
+AttitudeStats attitudeGetStats();
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2025 Orazio Franco <robora2025@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * @file blackbox.h
+ * @brief Flight recorder: full-rate IMU and motor data logged to flash.
+ *
+ * While a recording is running every IMU sample taken by `telemetryTick()`
+ * is pushed, together with the motor targets, the joystick setpoint and the
+ * battery voltage, into a lock-free ring. A low priority writer task drains
+ * the ring, compresses the records (field deltas, zigzag varints) into
+ * @ref BLACKBOX_BLOCK_SIZE blocks and appends whole blocks to
+ * @ref BLACKBOX_FILE on the filesystem partition. The producer side is one
+ * copy into the ring: no encoding and no flash access ever runs in the loop
+ * task, so motor updates are never delayed by the log.
+ *
+ * Every block starts with a @ref BlackboxBlockHdr and with a full record, so
+ * any block can be decoded on its own and the file can be downloaded in
+ * pieces with HTTP range requests.
+ */
+#pragma once
+#include <Arduino.h>
+#include "all_define.h"
+
+/**
+ * @struct BlackboxSample
+ * @brief One record of the flight recorder, before compression.
+ *
+ * The fields are encoded in this order (see @ref BlackboxField).
+ */
+typedef struct sBlackboxSample
+{
+  uint32_t tUs;      ///< @brief `esp_timer_get_time()` of the IMU sample, low 32 bits.
+  int16_t angle[3];  ///< @brief Pitch, roll, yaw, 0.01 deg.
+  int16_t temp;      ///< @brief IMU temperature, 0.01 C.
+  int16_t q[4];      ///< @brief Attitude quaternion w, x, y, z, Q14 (0 in register mode).
+  int32_t targetA;   ///< @brief Last target of motor A (`motorsGetLastTargetA()`).
+  int32_t targetB;   ///< @brief Last target of motor B (`motorsGetLastTargetB()`).
+  int16_t throttle;  ///< @brief Joystick throttle.
+  int16_t steer;     ///< @brief Joystick steer.
+  uint16_t battery;  ///< @brief Battery voltage, mV.
+} BlackboxSample;
+
+/**
+ * @enum BlackboxField
+ * @brief Order of the fields in a compressed record.
+ */
+enum BlackboxField : uint8_t
+{
+  BB_F_TIME = 0, ///< Time delta, us (always present).
+  BB_F_PITCH,
+  BB_F_ROLL,
+  BB_F_YAW,
+  BB_F_TEMP,
+  BB_F_QW,
+  BB_F_QX,
+  BB_F_QY,
+  BB_F_QZ,
+  BB_F_TARGET_A,
+  BB_F_TARGET_B,
+  BB_F_THROTTLE,
+  BB_F_STEER,
+  BB_F_BATTERY,
+  BB_F_COUNT
+};
+
+/// @brief Magic number of a block, "RBB1" in the file.
+#define BLACKBOX_MAGIC 0x31424252u
+
+/**
+ * @struct BlackboxBlockHdr
+ * @brief Header of a @ref BLACKBOX_BLOCK_SIZE block of the log file.
+ *
+ * It is followed by `count` records, `used` bytes in total. A record is a
+ * 16-bit little-endian mask of the fields that changed (bit `1 << BlackboxField`)
+ * and one zigzag LEB128 varint per set bit, with the difference from the
+ * previous record of the block. The first record of a block is relative to
+ * an all-zero record. The rest of the block is padding.
+ */
+typedef struct __attribute__((packed)) sBlackboxBlockHdr
+{
+  uint32_t magic;  ///< @brief @ref BLACKBOX_MAGIC.
+  uint16_t index;  ///< @brief Block number in the recording, from 0.
+  uint16_t count;  ///< @brief Records in the block.
+  uint16_t used;   ///< @brief Bytes of records after the header.
+  uint8_t fields;  ///< @brief @ref BB_F_COUNT, fields of a record.
+  uint8_t ver;     ///< @brief Format version, 1.
+} BlackboxBlockHdr;
+
+static_assert(sizeof(BlackboxBlockHdr) == 12, "BlackboxBlockHdr must be 12 bytes");
+
+/**
+ * @struct BlackboxStatus
+ * @brief State of the flight recorder.
+ */
+typedef struct sBlackboxStatus
+{
+  bool recording = false; ///< @brief A recording is running.
+  bool full = false;      ///< @brief The last recording stopped because the file reached its size.
+  uint32_t bytes = 0;     ///< @brief Bytes written to the file (whole blocks).
+  uint32_t capacity = 0;  ///< @brief Size reserved for the file.
+  uint32_t records = 0;   ///< @brief Records written.
+  uint32_t dropped = 0;   ///< @brief Samples lost because the ring was full.
+} BlackboxStatus;
+
+/**
+ * @brief Starts a new recording, replacing the previous file.
+ *
+ * The file is opened by the writer task, so the call returns immediately.
+ * @param kb Size reserved for the file in KB, reduced to the free space of the partition.
+ * @return false if @p kb is 0.
+ */
+bool blackboxStart(uint16_t kb);
+
+/**
+ * @brief Stops the recording; the last partial block is written by the writer task.
+ */
+void blackboxStop();
+
+/**
+ * @brief Tells if samples are being recorded.
+ *
+ * Cheap enough to be called for every IMU sample.
+ * @return true while a recording is running.
+ */
+bool blackboxRecording();
+
+/**
+ * @brief Queues one sample (producer side, loop task only).
+ *
+ * Fills the motor, joystick and battery fields of @p s and copies it into
+ * the ring; never blocks.
+ * @param s The sample with the IMU fields set.
+ */
+void blackboxLog(BlackboxSample &s);
+
+/**
+ * @brief Gets the state of the flight recorder.
+ *
+ * @return A copy of the state.
+ */
+BlackboxStatus blackboxGetStatus();
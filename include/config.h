@@ -143,6 +143,14 @@ typedef struct sMotoCfg
     bool invertB;
     bool tankInvThr;
     bool tankInvStr;
+    uint16_t ctrlHz;
+    uint16_t accel;
+    uint16_t decel;
+    bool interp;
+    uint16_t deadline;
+    bool brake;
+    bool lutMix;
+    char curve[CONFIG_STRING_LEN];
 } MotoCfg;
 
 /**
@@ -170,6 +178,20 @@ typedef struct sTeleCfg
 {
     bool enable ;
     uint32_t refresh ;
+    bool fifo;
+    uint16_t odr;
+    uint8_t aggMask;
+    bool delta;
+    uint16_t keyMs;
+    uint16_t dbAngle;
+    uint16_t dbTemp;
+    uint16_t dbBatt;
+    uint16_t alrTilt;
+    uint16_t alrBatt;
+    uint8_t filter;
+    uint8_t attHz;
+    uint8_t histKB;
+    uint16_t bbKB;
 } TeleCfg;
 
 /**
@@ -292,6 +314,26 @@ bool configPutFloat(const char *key, float value);
  */
 bool configPutText(const char *key, const String &value);
 
+/**
+ * @brief Callback invoked after a parameter has been written and applied to the runtime structure.
+ * @param key The parameter key.
+ */
+typedef void (*ConfigChangeCb)(const char *key);
+
+/**
+ * @brief Registers a change callback for the parameters of a namespace.
+ *
+ * The `configPut*()` functions call it, key by key, after the runtime
+ * structure has been updated; the values loaded at boot or restored by
+ * `configSaveAllDefaults()` are not notified.
+ * @param pref_ns The namespace (e.g. @ref MOTO_PREF_NS).
+ * @param cb The callback.
+ * @return True if registered (or already registered), false if the table is full.
+ * @note The callback runs in the writer's context (AsyncTCP task for `config_wr`):
+ * it should only record the key and leave the work to the owner's loop.
+ */
+bool configOnChange(const char *pref_ns, ConfigChangeCb cb);
+
 /**
  * @brief Prints the current state of the configurations to the Serial port.
  */
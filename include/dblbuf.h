@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2025 Orazio Franco <robora2025@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * @file dblbuf.h
+ * @brief Lock-free double buffer for a value shared between two tasks.
+ *
+ * The writer fills the slot the reader is not using and then publishes it by
+ * bumping a version counter; the reader copies the published slot and checks
+ * that the version did not move meanwhile (it retries if the writer published
+ * twice during the copy). The reader never blocks and never disables the
+ * interrupts. Writers must be serialized by the caller.
+ *
+ * The header only depends on the C++ standard library so it can also be
+ * built on the host.
+ */
+#pragma once
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * @class DoubleBuf
+ * @brief Two slots of type @p T and the version of the published one.
+ *
+ * @tparam T Value type, copied by value.
+ */
+template <typename T>
+class DoubleBuf
+{
+public:
+    /**
+     * @brief Publishes a new value (writer side).
+     * @param v The value.
+     */
+    void write(const T &v)
+    {
+        uint32_t n = ver.load(std::memory_order_relaxed) + 1;
+        slot[n & 1] = v;
+        ver.store(n, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copies the last published value (reader side).
+     * @param out The copy.
+     * @return The version of the value, it changes at every write.
+     */
+    uint32_t read(T &out) const
+    {
+        for (;;)
+        {
+            uint32_t v = ver.load(std::memory_order_acquire);
+            out = slot[v & 1];
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (ver.load(std::memory_order_relaxed) == v)
+                return v;
+        }
+    }
+
+private:
+    T slot[2] = {};                 ///< @brief Value slots, the published one is `slot[ver & 1]`.
+    std::atomic<uint32_t> ver{0};   ///< @brief Number of writes.
+};
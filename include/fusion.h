@@ -0,0 +1,461 @@
+/*
+ * Copyright (c) 2025 Orazio Franco <robora2025@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * @file fusion.h
+ * @brief Attitude fusion filters: float complementary and fixed-point quaternion filters.
+ *
+ * The ESP32-C3 has no FPU, so besides the original complementary filter on
+ * float Euler angles this file provides three quaternion filters in integer
+ * arithmetic (Q30, only 32x32->64 multiplies, one 64/32 division per
+ * normalization):
+ * - complementary on SO(3) (Mahony with the proportional term only);
+ * - Mahony, proportional + integral (estimates the gyro bias);
+ * - Madgwick, gradient descent step towards the gravity direction.
+ *
+ * All the filters give a quaternion and Euler angles (Q16 degrees). The code
+ * has no Arduino dependency, so `bench/fusion_bench.cpp` can run it on the
+ * host against recorded or synthetic IMU traces. Header only, no allocation;
+ * the state is not protected, use it from one task.
+ */
+#pragma once
+#include <stdint.h>
+#include <math.h>
+
+/**
+ * @enum FusionFilter
+ * @brief Selectable fusion filters (telemetry parameter "filter").
+ */
+enum FusionFilter : uint8_t
+{
+    FUSION_COMPL_F = 0, ///< Complementary filter on float Euler angles (original filter).
+    FUSION_COMPL_Q,     ///< Complementary filter on the fixed-point quaternion.
+    FUSION_MAHONY_Q,    ///< Mahony (PI) on the fixed-point quaternion.
+    FUSION_MADGWICK_Q,  ///< Madgwick on the fixed-point quaternion.
+    FUSION_COUNT,
+};
+
+/// @brief 1.0 in Q30.
+#define FX_ONE (1L << 30)
+/// @brief Fractional bits of the Euler angles in degrees.
+#define FX_DEG_SHIFT 16
+
+/**
+ * @struct FusionParams
+ * @brief Sensor scales and gains, converted to fixed point by `fusionInit()`.
+ */
+typedef struct sFusionParams
+{
+    float odrHz;     ///< @brief Sample rate.
+    float accLsbG;   ///< @brief Accelerometer LSB per g.
+    float gyrLsbDps; ///< @brief Gyroscope LSB per deg/s.
+    float complK;    ///< @brief Gyro weight of @ref FUSION_COMPL_F (0..1).
+    float kp;        ///< @brief Proportional gain of the complementary and Mahony filters (1/s).
+    float ki;        ///< @brief Integral gain of the Mahony filter (1/s^2).
+    float beta;      ///< @brief Madgwick gain (rad/s).
+} FusionParams;
+
+/**
+ * @struct Fusion
+ * @brief State of a fusion filter.
+ */
+typedef struct sFusion
+{
+    FusionFilter filter = FUSION_COMPL_F; ///< @brief Selected filter.
+    bool valid = false;                   ///< @brief False until the first sample initialized the estimate.
+    int32_t q[4] = {FX_ONE, 0, 0, 0};     ///< @brief Quaternion w, x, y, z (Q30).
+    int64_t bias[3] = {0, 0, 0};          ///< @brief Mahony integral term, half angle per sample (Q46).
+    int32_t gyrK = 0;                     ///< @brief Gyro LSB to half angle per sample (Q46).
+    int32_t kp = 0;                       ///< @brief Kp * dt / 2 (Q30).
+    int32_t ki = 0;                       ///< @brief Ki * dt * dt / 2 (Q30).
+    int32_t beta = 0;                     ///< @brief beta * dt (Q30).
+    float dt = 0;                         ///< @brief Sample period (s), float filter.
+    float accScale = 0;                   ///< @brief Accelerometer LSB to g, float filter.
+    float gyrScale = 0;                   ///< @brief Gyroscope LSB to deg/s, float filter.
+    float complK = 0;                     ///< @brief Gyro weight, float filter.
+    float euler[3] = {0, 0, 0};           ///< @brief Pitch, roll, yaw in degrees, float filter.
+} Fusion;
+
+/**
+ * @brief Q30 multiply.
+ */
+static inline int32_t fxMul(int32_t a, int32_t b)
+{
+    return (int32_t)(((int64_t)a * b) >> 30);
+}
+
+/**
+ * @brief Integer square root of a 64-bit value (digit by digit).
+ */
+static inline uint32_t fxIsqrt64(uint64_t v)
+{
+    uint64_t r = 0, bit = 1ULL << 62;
+    while (bit > v)
+        bit >>= 2;
+    while (bit)
+    {
+        if (v >= r + bit)
+        {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        }
+        else
+            r >>= 1;
+        bit >>= 2;
+    }
+    return (uint32_t)r;
+}
+
+/**
+ * @brief Normalizes a vector of any scale to unit length in Q30.
+ *
+ * The components are first shifted so the largest one has its top bit at
+ * position 29, then scaled by the inverse of the integer norm.
+ * @param in Input components.
+ * @param out Output components (Q30), may not alias `in`.
+ * @param n Number of components (at most 4).
+ * @return false if the vector is zero (`out` untouched).
+ */
+static inline bool fxNormalize(const int64_t *in, int32_t *out, int n)
+{
+    uint64_t m = 0;
+    for (int i = 0; i < n; i++)
+        m |= (uint64_t)(in[i] < 0 ? -in[i] : in[i]);
+    if (!m)
+        return false;
+    int sh = __builtin_clzll(m) - 34;
+    int32_t v[4];
+    uint64_t s = 0;
+    for (int i = 0; i < n; i++)
+    {
+        v[i] = (int32_t)(sh >= 0 ? (int64_t)((uint64_t)in[i] << sh) : in[i] >> -sh);
+        s += (uint64_t)((int64_t)v[i] * v[i]);
+    }
+    uint32_t norm = fxIsqrt64(s);
+    uint32_t inv = (uint32_t)((1ULL << 60) / norm);
+    for (int i = 0; i < n; i++)
+        out[i] = (int32_t)(((int64_t)v[i] * inv) >> 30);
+    return true;
+}
+
+/**
+ * @brief Renormalizes a quaternion that is already close to unit length.
+ *
+ * One Newton step of the inverse square root starting from 1,
+ * `q *= (3 - |q|^2) / 2`: the error after a filter step is far below the Q30
+ * resolution, so the integer square root and the division are not needed.
+ * Falls back to `fxNormalize()` if the norm drifted away.
+ * @param q Quaternion w, x, y, z (Q30), updated in place.
+ */
+static inline void fxRenorm(int32_t q[4])
+{
+    int64_t s = 0;
+    for (int i = 0; i < 4; i++)
+        s += (int64_t)q[i] * q[i];
+    s >>= 30;
+    if (s < FX_ONE - (FX_ONE >> 8) || s > FX_ONE + (FX_ONE >> 8))
+    {
+        const int64_t v[4] = {q[0], q[1], q[2], q[3]};
+        fxNormalize(v, q, 4);
+        return;
+    }
+    const int32_t k = (int32_t)((3 * (int64_t)FX_ONE - s) >> 1);
+    for (int i = 0; i < 4; i++)
+        q[i] = fxMul(q[i], k);
+}
+
+/**
+ * @brief atan2 with CORDIC, 16 iterations.
+ *
+ * @param y,x Arguments, same scale, |x|,|y| < 2^31.
+ * @return The angle in Q16 degrees, -180..180.
+ */
+static inline int32_t fxAtan2(int32_t y, int32_t x)
+{
+    static const int32_t tab[16] = {2949120, 1740967, 919879, 466945, 234379, 117304, 58666, 29335,
+                                    14668, 7334, 3667, 1833, 917, 458, 229, 115};
+    if (x == 0 && y == 0)
+        return 0;
+    int32_t a = 0;
+    if (x < 0)
+    {
+        a = y >= 0 ? (180 << FX_DEG_SHIFT) : -(180 << FX_DEG_SHIFT);
+        x = -x;
+        y = -y;
+    }
+    // margine per il guadagno CORDIC (1.65) e la somma x + y
+    x >>= 2;
+    y >>= 2;
+    for (int i = 0; i < 16; i++)
+    {
+        int32_t xs = x >> i, ys = y >> i;
+        if (y > 0)
+        {
+            x += ys;
+            y -= xs;
+            a += tab[i];
+        }
+        else
+        {
+            x -= ys;
+            y += xs;
+            a -= tab[i];
+        }
+    }
+    if (a > (180 << FX_DEG_SHIFT))
+        a -= 360 << FX_DEG_SHIFT;
+    else if (a < -(180 << FX_DEG_SHIFT))
+        a += 360 << FX_DEG_SHIFT;
+    return a;
+}
+
+/**
+ * @brief Euler angles of a unit quaternion (Z-Y-X).
+ *
+ * @param q Quaternion w, x, y, z (Q30).
+ * @param e Output: pitch, roll, yaw in Q16 degrees.
+ */
+static inline void fxQuatEuler(const int32_t q[4], int32_t e[3])
+{
+    const int32_t w = q[0], x = q[1], y = q[2], z = q[3];
+    const int32_t ww = fxMul(w, w), xx = fxMul(x, x), yy = fxMul(y, y), zz = fxMul(z, z);
+    int64_t sp = 2 * ((int64_t)fxMul(w, y) - fxMul(x, z));
+    if (sp > FX_ONE)
+        sp = FX_ONE;
+    else if (sp < -FX_ONE)
+        sp = -FX_ONE;
+    const int32_t cp = (int32_t)fxIsqrt64((uint64_t)((int64_t)FX_ONE * FX_ONE - sp * sp));
+    e[0] = fxAtan2((int32_t)sp, cp);
+    // atan2 non dipende dalla scala: argomenti dimezzati, niente overflow
+    e[1] = fxAtan2(fxMul(w, x) + fxMul(y, z), (ww - xx - yy + zz) / 2);
+    e[2] = fxAtan2(fxMul(w, z) + fxMul(x, y), (ww + xx - yy - zz) / 2);
+}
+
+/**
+ * @brief Unit quaternion of Euler angles (Z-Y-X), float.
+ *
+ * @param pitch,roll,yaw Angles in degrees.
+ * @param q Output: w, x, y, z (Q30).
+ */
+static inline void fxEulerQuat(float pitch, float roll, float yaw, int32_t q[4])
+{
+    const float k = (float)(M_PI / 360.0); // gradi -> semiangolo in radianti
+    const float sp = sinf(pitch * k), cp = cosf(pitch * k);
+    const float sr = sinf(roll * k), cr = cosf(roll * k);
+    const float sy = sinf(yaw * k), cy = cosf(yaw * k);
+    q[0] = (int32_t)lroundf((cr * cp * cy + sr * sp * sy) * FX_ONE);
+    q[1] = (int32_t)lroundf((sr * cp * cy - cr * sp * sy) * FX_ONE);
+    q[2] = (int32_t)lroundf((cr * sp * cy + sr * cp * sy) * FX_ONE);
+    q[3] = (int32_t)lroundf((cr * cp * sy - sr * sp * cy) * FX_ONE);
+}
+
+/**
+ * @brief Configures a filter and resets its state.
+ *
+ * @param f The filter.
+ * @param filter The algorithm.
+ * @param p Scales and gains.
+ */
+static inline void fusionInit(Fusion *f, FusionFilter filter, const FusionParams &p)
+{
+    *f = Fusion();
+    f->filter = filter;
+    const double dt = 1.0 / p.odrHz;
+    f->gyrK = (int32_t)lround(M_PI / 180.0 / p.gyrLsbDps * dt / 2.0 * 70368744177664.0); // 2^46
+    f->kp = (int32_t)lround(p.kp * dt / 2.0 * FX_ONE);
+    f->ki = (int32_t)lround(p.ki * dt * dt / 2.0 * FX_ONE);
+    f->beta = (int32_t)lround(p.beta * dt * FX_ONE);
+    f->dt = (float)dt;
+    f->accScale = 1.0f / p.accLsbG;
+    f->gyrScale = 1.0f / p.gyrLsbDps;
+    f->complK = p.complK;
+}
+
+/**
+ * @brief Restarts the estimate: the next sample initializes it from the accelerometer.
+ */
+static inline void fusionReset(Fusion *f)
+{
+    f->valid = false;
+    f->q[0] = FX_ONE;
+    f->q[1] = f->q[2] = f->q[3] = 0;
+    f->bias[0] = f->bias[1] = f->bias[2] = 0;
+    f->euler[0] = f->euler[1] = f->euler[2] = 0;
+}
+
+/**
+ * @brief Original complementary filter on float Euler angles.
+ */
+static inline void fusionComplF(Fusion *f, const int16_t acc[3], const int16_t gyr[3])
+{
+    const float ax = acc[0] * f->accScale, ay = acc[1] * f->accScale, az = acc[2] * f->accScale;
+    const float accPitch = atan2f(-ax, sqrtf(ay * ay + az * az)) * (float)(180.0 / M_PI);
+    const float accRoll = atan2f(ay, az) * (float)(180.0 / M_PI);
+    if (!f->valid)
+    {
+        f->euler[0] = accPitch;
+        f->euler[1] = accRoll;
+        f->euler[2] = 0;
+        f->valid = true;
+        return;
+    }
+    const float k = f->complK, dt = f->dt;
+    f->euler[0] = k * (f->euler[0] + gyr[1] * f->gyrScale * dt) + (1.0f - k) * accPitch;
+    f->euler[1] = k * (f->euler[1] + gyr[0] * f->gyrScale * dt) + (1.0f - k) * accRoll;
+    f->euler[2] += gyr[2] * f->gyrScale * dt;
+    if (f->euler[2] > 180.0f)
+        f->euler[2] -= 360.0f;
+    else if (f->euler[2] < -180.0f)
+        f->euler[2] += 360.0f;
+}
+
+/**
+ * @brief Initial quaternion from the gravity direction (yaw 0).
+ *
+ * `q = normalize(1 + az, ay, -ax, 0)` is the shortest rotation that maps the
+ * world vertical onto the measured (normalized) gravity `a`.
+ */
+static inline void fusionInitFromAcc(Fusion *f, const int32_t a[3])
+{
+    const int64_t v[4] = {(int64_t)FX_ONE + a[2], a[1], -(int64_t)a[0], 0};
+    if (!fxNormalize(v, f->q, 4))
+    {
+        // capovolto: 180 gradi attorno a X
+        f->q[0] = 0;
+        f->q[1] = FX_ONE;
+        f->q[2] = f->q[3] = 0;
+    }
+    f->valid = true;
+}
+
+/**
+ * @brief One step of the fixed-point quaternion filters.
+ */
+static inline void fusionUpdateQ(Fusion *f, const int16_t acc[3], const int16_t gyr[3])
+{
+    const int64_t a64[3] = {acc[0], acc[1], acc[2]};
+    int32_t a[3];
+    const bool accOk = fxNormalize(a64, a, 3);
+    if (!f->valid)
+    {
+        if (accOk)
+            fusionInitFromAcc(f, a);
+        return;
+    }
+
+    // semiangolo di rotazione del campione: omega * dt / 2
+    int32_t h[3];
+    for (int i = 0; i < 3; i++)
+        h[i] = (int32_t)(((int64_t)gyr[i] * f->gyrK) >> 16);
+
+    const int32_t w = f->q[0], x = f->q[1], y = f->q[2], z = f->q[3];
+    int32_t corr[4] = {0, 0, 0, 0};
+    if (accOk && f->filter != FUSION_MADGWICK_Q)
+    {
+        // gravità stimata dal quaternione, errore = a x v
+        const int32_t vx = 2 * (fxMul(x, z) - fxMul(w, y));
+        const int32_t vy = 2 * (fxMul(w, x) + fxMul(y, z));
+        const int32_t vz = fxMul(w, w) - fxMul(x, x) - fxMul(y, y) + fxMul(z, z);
+        const int32_t e[3] = {fxMul(a[1], vz) - fxMul(a[2], vy), fxMul(a[2], vx) - fxMul(a[0], vz),
+                              fxMul(a[0], vy) - fxMul(a[1], vx)};
+        for (int i = 0; i < 3; i++)
+        {
+            if (f->filter == FUSION_MAHONY_Q)
+                f->bias[i] += ((int64_t)f->ki * e[i]) >> 14;
+            h[i] += fxMul(f->kp, e[i]) + (int32_t)(f->bias[i] >> 16);
+        }
+    }
+    else if (accOk)
+    {
+        // Madgwick: gradiente J^T f della funzione obiettivo verso la gravità
+        const int64_t f0 = 2 * ((int64_t)fxMul(x, z) - fxMul(w, y)) - a[0];
+        const int64_t f1 = 2 * ((int64_t)fxMul(w, x) + fxMul(y, z)) - a[1];
+        const int64_t f2 = (int64_t)fxMul(w, w) - fxMul(x, x) - fxMul(y, y) + fxMul(z, z) - a[2];
+        const int64_t s[4] = {
+            2 * ((-(int64_t)y * f0 + (int64_t)x * f1) >> 30),
+            2 * (((int64_t)z * f0 + (int64_t)w * f1) >> 30) - 4 * (((int64_t)x * f2) >> 30),
+            2 * ((-(int64_t)w * f0 + (int64_t)z * f1) >> 30) - 4 * (((int64_t)y * f2) >> 30),
+            2 * (((int64_t)x * f0 + (int64_t)y * f1) >> 30)};
+        int32_t sn[4];
+        if (fxNormalize(s, sn, 4))
+            for (int i = 0; i < 4; i++)
+                corr[i] = fxMul(f->beta, sn[i]);
+    }
+
+    // q += q * (0, h) - correzione
+    int32_t qn[4] = {w - fxMul(x, h[0]) - fxMul(y, h[1]) - fxMul(z, h[2]) - corr[0],
+                     x + fxMul(w, h[0]) + fxMul(y, h[2]) - fxMul(z, h[1]) - corr[1],
+                     y + fxMul(w, h[1]) - fxMul(x, h[2]) + fxMul(z, h[0]) - corr[2],
+                     z + fxMul(w, h[2]) + fxMul(x, h[1]) - fxMul(y, h[0]) - corr[3]};
+    fxRenorm(qn);
+    for (int i = 0; i < 4; i++)
+        f->q[i] = qn[i];
+}
+
+/**
+ * @brief Feeds one IMU sample to the selected filter.
+ *
+ * @param f The filter.
+ * @param acc Accelerometer, raw LSB.
+ * @param gyr Gyroscope, raw LSB.
+ */
+static inline void fusionUpdate(Fusion *f, const int16_t acc[3], const int16_t gyr[3])
+{
+    if (f->filter == FUSION_COMPL_F)
+        fusionComplF(f, acc, gyr);
+    else
+        fusionUpdateQ(f, acc, gyr);
+}
+
+/**
+ * @brief Euler angles of the current estimate.
+ *
+ * @param f The filter.
+ * @param e Output: pitch, roll, yaw in Q16 degrees.
+ */
+static inline void fusionEuler(const Fusion *f, int32_t e[3])
+{
+    if (f->filter == FUSION_COMPL_F)
+    {
+        for (int i = 0; i < 3; i++)
+            e[i] = (int32_t)lroundf(f->euler[i] * (1 << FX_DEG_SHIFT));
+        return;
+    }
+    fxQuatEuler(f->q, e);
+}
+
+/**
+ * @brief Quaternion of the current estimate.
+ *
+ * For @ref FUSION_COMPL_F it is computed from the Euler angles.
+ * @param f The filter.
+ * @param q Output: w, x, y, z (Q30).
+ */
+static inline void fusionQuat(const Fusion *f, int32_t q[4])
+{
+    if (f->filter != FUSION_COMPL_F)
+    {
+        for (int i = 0; i < 4; i++)
+            q[i] = f->q[i];
+        return;
+    }
+    fxEulerQuat(f->euler[0], f->euler[1], f->euler[2], q);
+}
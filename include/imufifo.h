@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2025 Orazio Franco <robora2025@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * @file imufifo.h
+ * @brief Hardware FIFO mode of the ICM42670 IMU.
+ *
+ * The RobOra_42670 driver reads the data registers one sample at a time.
+ * This module programs the on-chip FIFO of the ICM42670 (accel + gyro
+ * packets of 16 bytes at the chosen ODR) through direct register access on
+ * the same I2C bus, and drains it with burst reads: one transaction for the
+ * record count and one for every @ref IMU_FIFO_BURST bytes of packets.
+ */
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+#include "all_define.h"
+
+/**
+ * @struct ImuRaw
+ * @brief One accel + gyro sample decoded from the FIFO (sensor units).
+ *
+ * Scales: accel @ref IMU_FIFO_ACC_LSB_G LSB/g, gyro @ref IMU_FIFO_GYR_LSB_DPS
+ * LSB/dps, temperature `t / 2 + 25` C.
+ */
+typedef struct sImuRaw
+{
+  int16_t acc[3];  ///< @brief Accelerometer X, Y, Z.
+  int16_t gyr[3];  ///< @brief Gyroscope X, Y, Z.
+  int8_t temp;     ///< @brief Temperature, 0.5 C / LSB, 0 = 25 C.
+  uint16_t ts;     ///< @brief Sensor timestamp of the packet (us, wraps at 65536).
+} ImuRaw;
+
+/**
+ * @brief Enables the FIFO at the given output data rate.
+ *
+ * Must be called after the driver initialization (`ROBORA_42670::Init()`).
+ * Sets both sensors in low-noise mode at the ODR closest to @p odrHz (25,
+ * 50, 100, 200 or 400 Hz), selects stream mode with accel and gyro packets
+ * and flushes the FIFO.
+ * @param odrHz The requested output data rate in Hz.
+ * @return The ODR actually programmed in Hz, 0 if the IMU did not answer.
+ */
+uint16_t imuFifoBegin(uint16_t odrHz);
+
+/**
+ * @brief Disables the FIFO (bypass mode).
+ */
+void imuFifoEnd();
+
+/**
+ * @brief Drains the FIFO.
+ *
+ * Reads the number of queued packets and then the packets themselves in
+ * burst transactions. Invalid or empty packets are skipped.
+ * @param out Destination of the decoded samples.
+ * @param max Capacity of @p out.
+ * @return The number of samples written to @p out.
+ */
+size_t imuFifoRead(ImuRaw *out, size_t max);
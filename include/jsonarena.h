@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2025 Orazio Franco <robora2025@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * @file jsonarena.h
+ * @brief ArduinoJson allocators over preallocated memory, with allocation counters.
+ *
+ * A @ref JsonArena is a bump allocator over a fixed buffer: documents built
+ * while handling one message take their memory from it and the whole arena is
+ * released at once with `reset()`. Requests that do not fit fall back to the
+ * heap and are counted, so the steady state can be verified to run without
+ * `malloc` calls.
+ */
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+/**
+ * @struct sJsonArenaStats
+ * @brief Allocation counters shared by all the arenas and by @ref JsonHeapAllocator.
+ */
+typedef struct sJsonArenaStats
+{
+    uint32_t arenaAllocs; ///< @brief Allocations served from an arena.
+    uint32_t heapAllocs;  ///< @brief Allocations that went to the heap (`malloc`/`realloc`).
+    uint32_t resets;      ///< @brief Number of arena resets.
+    uint32_t peak;        ///< @brief Highest number of bytes used in a single arena.
+} JsonArenaStats;
+
+/**
+ * @class JsonArena
+ * @brief Bump allocator for ArduinoJson over a caller-provided buffer.
+ *
+ * `deallocate()` only gives memory back if the block is the last one
+ * allocated, and `reallocate()` grows the last block in place: this matches
+ * the way ArduinoJson builds strings and pools, so a message is parsed and
+ * answered without copies. Everything is released by `reset()`.
+ */
+class JsonArena : public ArduinoJson::Allocator
+{
+public:
+    /**
+     * @brief Creates an arena over a buffer.
+     * @param mem The buffer, 8-byte aligned.
+     * @param size The buffer size in bytes.
+     */
+    JsonArena(uint8_t *mem, size_t size) : base(mem), cap(size) {}
+
+    void *allocate(size_t size) override;
+    void deallocate(void *ptr) override;
+    void *reallocate(void *ptr, size_t new_size) override;
+
+    /**
+     * @brief Releases all the blocks. No document may still use the arena.
+     */
+    void reset();
+
+    /**
+     * @brief Number of bytes currently used.
+     */
+    size_t used() const { return top; }
+
+    /**
+     * @brief Size of the arena in bytes.
+     */
+    size_t capacity() const { return cap; }
+
+private:
+    bool owns(const void *ptr) const;
+
+    uint8_t *base;              ///< @brief Start of the buffer.
+    size_t cap;                 ///< @brief Size of the buffer.
+    size_t top = 0;             ///< @brief First free byte.
+    size_t last = SIZE_MAX;     ///< @brief Offset of the last block (SIZE_MAX if unknown).
+};
+
+/**
+ * @class JsonHeapAllocator
+ * @brief Heap allocator for ArduinoJson that updates @ref JsonArenaStats.
+ *
+ * Used for documents that have no arena, so their heap usage is visible in
+ * the same counters.
+ */
+class JsonHeapAllocator : public ArduinoJson::Allocator
+{
+public:
+    void *allocate(size_t size) override;
+    void deallocate(void *ptr) override;
+    void *reallocate(void *ptr, size_t new_size) override;
+
+    /**
+     * @brief Shared instance.
+     */
+    static JsonHeapAllocator *instance();
+};
+
+/**
+ * @brief Returns a copy of the allocation counters.
+ * @return The @ref JsonArenaStats.
+ */
+JsonArenaStats jsonArenaGetStats();
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2025 Orazio Franco <robora2025@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * @file lathist.h
+ * @brief Compact log-linear latency histogram.
+ *
+ * Values (microseconds) are counted in buckets that are linear below 4 and
+ * then split every power of two in @ref LAT_HIST_SUB steps, so the relative
+ * error of a percentile is below 25% from a few microseconds up to about two
+ * seconds with only @ref LAT_HIST_BUCKETS counters. When the number of
+ * samples reaches @ref LAT_HIST_WINDOW all the counters are halved, so the
+ * percentiles follow the recent behaviour of the link (rolling window with
+ * exponential decay).
+ *
+ * The header only depends on the C library, it does no allocation and no
+ * locking: every histogram must be updated and read by a single task.
+ */
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+#define LAT_HIST_SUB 4       ///< Sub-buckets per power of two.
+#define LAT_HIST_BUCKETS 80  ///< Number of buckets, the last one also counts all the larger values (>= ~2 s).
+#define LAT_HIST_WINDOW 512  ///< Number of samples after which the counters are halved.
+
+/**
+ * @struct LatHist
+ * @brief Rolling log-linear histogram of latencies in microseconds.
+ */
+typedef struct sLatHist
+{
+    uint16_t count[LAT_HIST_BUCKETS]; ///< @brief Samples per bucket.
+    uint16_t total;                   ///< @brief Sum of @ref count.
+    uint32_t last;                    ///< @brief Last added value.
+    uint32_t max;                     ///< @brief Largest value since the last reset.
+} LatHist;
+
+/**
+ * @brief Clears a histogram.
+ * @param h The histogram.
+ */
+static inline void latHistReset(LatHist *h)
+{
+    memset(h, 0, sizeof(*h));
+}
+
+/**
+ * @brief Returns the bucket of a value.
+ * @param v The value in microseconds.
+ * @return The bucket index, in [0, LAT_HIST_BUCKETS).
+ */
+static inline uint8_t latHistBucket(uint32_t v)
+{
+    if (v < LAT_HIST_SUB)
+        return (uint8_t)v;
+    uint32_t e = 31 - __builtin_clz(v); // e >= 2
+    uint32_t idx = (e - 1) * LAT_HIST_SUB + ((v >> (e - 2)) & (LAT_HIST_SUB - 1));
+    return (uint8_t)(idx < LAT_HIST_BUCKETS ? idx : LAT_HIST_BUCKETS - 1);
+}
+
+/**
+ * @brief Returns the smallest value counted in a bucket.
+ * @param idx The bucket index.
+ * @return The lower bound of the bucket in microseconds.
+ */
+static inline uint32_t latHistBucketLow(uint8_t idx)
+{
+    if (idx < LAT_HIST_SUB)
+        return idx;
+    uint32_t e = idx / LAT_HIST_SUB + 1;
+    return (uint32_t)(LAT_HIST_SUB + idx % LAT_HIST_SUB) << (e - 2);
+}
+
+/**
+ * @brief Adds a sample.
+ * @param h The histogram.
+ * @param v The value in microseconds.
+ */
+static inline void latHistAdd(LatHist *h, uint32_t v)
+{
+    if (h->total >= LAT_HIST_WINDOW)
+    {
+        h->total = 0;
+        for (uint8_t i = 0; i < LAT_HIST_BUCKETS; i++)
+        {
+            h->count[i] >>= 1;
+            h->total += h->count[i];
+        }
+    }
+    h->count[latHistBucket(v)]++;
+    h->total++;
+    h->last = v;
+    if (v > h->max)
+        h->max = v;
+}
+
+/**
+ * @brief Computes a percentile.
+ *
+ * The result is the upper bound of the bucket holding the percentile, so it
+ * never underestimates the latency.
+ *
+ * @param h The histogram.
+ * @param pct The percentile, 1..100.
+ * @return The percentile in microseconds, 0 if the histogram is empty.
+ */
+static inline uint32_t latHistPercentile(const LatHist *h, uint8_t pct)
+{
+    if (h->total == 0)
+        return 0;
+    uint32_t target = ((uint32_t)h->total * pct + 99) / 100;
+    uint32_t acc = 0;
+    for (uint8_t i = 0; i < LAT_HIST_BUCKETS; i++)
+    {
+        acc += h->count[i];
+        if (acc >= target)
+            return (i + 1 < LAT_HIST_BUCKETS) ? latHistBucketLow(i + 1) - 1 : h->max;
+    }
+    return h->max;
+}
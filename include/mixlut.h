@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2025 Orazio Franco <robora2025@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * @file mixlut.h
+ * @brief Integer lookup-table shaping of the throttle and steer setpoints.
+ *
+ * Deadzone, response curve (expo or user control points) and steer gain are
+ * folded into one 255-entry table per axis, indexed by the setpoint
+ * (-127..127). The tables are built once when the motor configuration
+ * changes, so every control period costs two table reads instead of the
+ * float math of the driver. The tank/arcade mixing and the inversions stay
+ * in `RoBoRa_8833::driveTank()`, with its own shaping set to neutral.
+ *
+ * - Deadzone: inputs with `|v| <= deadzone% of 127` give 0, the rest of the
+ *   range is stretched back to 1..127.
+ * - Expo: `y = (1 - e) x + e x^3` on the normalized input, `e = expoPct / 100`.
+ * - Curve: piecewise linear through user points `x:y` (0..127, `x` strictly
+ *   increasing, `(0,0)` and `(127,127)` implied), odd-symmetric; it replaces
+ *   the expo when valid.
+ * - Steer gain: the steer table is scaled by `steerGain / 100`.
+ *
+ * The header only depends on the C library so it can also be built on the
+ * host (see `bench/mixlut_bench.cpp`).
+ */
+#pragma once
+#include <stdint.h>
+#include <stdlib.h>
+
+#define MIX_LUT_SIZE 255        ///< Table entries, one per setpoint -127..127.
+#define MIX_CURVE_MAX_POINTS 8  ///< User control points of the curve.
+
+/**
+ * @struct MixCurvePoint
+ * @brief Control point of the response curve, on the magnitude of the setpoint.
+ */
+typedef struct sMixCurvePoint
+{
+    uint8_t x; ///< @brief Input, 0..127.
+    uint8_t y; ///< @brief Output, 0..127.
+} MixCurvePoint;
+
+/**
+ * @struct MixLutCfg
+ * @brief Parameters the tables are built from (same meaning as in @ref MotoCfg).
+ */
+typedef struct sMixLutCfg
+{
+    uint8_t deadzone;                         ///< @brief Deadzone, % of full scale.
+    uint8_t expoPct;                          ///< @brief Expo, %.
+    uint8_t steerGain;                        ///< @brief Steer gain, %.
+    uint8_t points;                           ///< @brief Valid entries of @ref curve, 0 = expo.
+    MixCurvePoint curve[MIX_CURVE_MAX_POINTS]; ///< @brief User control points.
+} MixLutCfg;
+
+/**
+ * @struct MixLut
+ * @brief Shaping tables, index = setpoint + 127.
+ */
+typedef struct sMixLut
+{
+    int8_t thr[MIX_LUT_SIZE]; ///< @brief Throttle table.
+    int8_t str[MIX_LUT_SIZE]; ///< @brief Steer table.
+} MixLut;
+
+/**
+ * @brief Parses the user control points of the curve.
+ *
+ * Format: `x:y` pairs separated by commas, e.g. `"32:10,64:40,96:80"`.
+ *
+ * @param text The points.
+ * @param cfg Receives the points (@ref MixLutCfg::points = 0 if @p text is empty).
+ * @return false if @p text is not a valid curve, @p cfg then uses the expo.
+ */
+static inline bool mixLutParseCurve(const char *text, MixLutCfg *cfg)
+{
+    cfg->points = 0;
+    if (!text || !*text)
+        return true;
+    const char *p = text;
+    uint8_t n = 0;
+    int lastX = 0;
+    while (*p)
+    {
+        char *end;
+        long x = strtol(p, &end, 10);
+        if (end == p || *end != ':')
+            return false;
+        p = end + 1;
+        long y = strtol(p, &end, 10);
+        if (end == p || (*end && *end != ',') || n == MIX_CURVE_MAX_POINTS)
+            return false;
+        if (x <= lastX || x > 127 || y < 0 || y > 127)
+            return false;
+        cfg->curve[n].x = (uint8_t)x;
+        cfg->curve[n].y = (uint8_t)y;
+        n++;
+        lastX = (int)x;
+        p = *end ? end + 1 : end;
+    }
+    cfg->points = n;
+    return true;
+}
+
+/**
+ * @brief Response curve on the magnitude of the setpoint, after the deadzone.
+ *
+ * @param cfg The parameters.
+ * @param x Input, 0..127 in Q8.
+ * @return Output, 0..127 in Q8.
+ */
+static inline int32_t mixLutCurve(const MixLutCfg *cfg, int32_t x)
+{
+    const int32_t full = 127 << 8;
+    if (cfg->points)
+    {
+        int32_t x0 = 0, y0 = 0;
+        for (uint8_t i = 0; i <= cfg->points; i++)
+        {
+            int32_t x1 = (i < cfg->points ? cfg->curve[i].x : 127) << 8;
+            int32_t y1 = (i < cfg->points ? cfg->curve[i].y : 127) << 8;
+            if (x <= x1)
+                return y0 + (int32_t)((int64_t)(y1 - y0) * (x - x0) / (x1 - x0));
+            x0 = x1;
+            y0 = y1;
+        }
+        return full;
+    }
+    int32_t cube = (int32_t)((int64_t)x * x / full * x / full); // x^3 / full^2
+    return (x * (100 - cfg->expoPct) + cube * cfg->expoPct) / 100;
+}
+
+/**
+ * @brief Builds the shaping tables.
+ *
+ * The intermediate values are in Q8, so the table entries differ from the
+ * float math by rounding only.
+ *
+ * @param lut The tables.
+ * @param cfg The parameters.
+ */
+static inline void mixLutBuild(MixLut *lut, const MixLutCfg *cfg)
+{
+    const int32_t dz = (cfg->deadzone * 127 + 50) / 100;
+    for (int32_t v = -127; v <= 127; v++)
+    {
+        int32_t a = v < 0 ? -v : v;
+        int32_t y = 0; // Q8
+        if (a > dz && dz < 127)
+            y = mixLutCurve(cfg, ((a - dz) * (127 << 8)) / (127 - dz));
+        int32_t t = (y + 128) >> 8;
+        int32_t s = (y * cfg->steerGain / 100 + 128) >> 8;
+        if (s > 127)
+            s = 127;
+        lut->thr[v + 127] = (int8_t)(v < 0 ? -t : t);
+        lut->str[v + 127] = (int8_t)(v < 0 ? -s : s);
+    }
+}
+
+/**
+ * @brief Shapes a setpoint.
+ *
+ * @param lut The tables.
+ * @param throttle Throttle, clamped to -127..127.
+ * @param steer Steer, clamped to -127..127.
+ * @param out Shaped throttle and steer.
+ */
+static inline void mixLutApply(const MixLut *lut, int16_t throttle, int16_t steer, int16_t out[2])
+{
+    throttle = throttle < -127 ? -127 : (throttle > 127 ? 127 : throttle);
+    steer = steer < -127 ? -127 : (steer > 127 ? 127 : steer);
+    out[0] = lut->thr[throttle + 127];
+    out[1] = lut->str[steer + 127];
+}
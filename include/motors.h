@@ -29,7 +29,50 @@
 #pragma once
 #include <Arduino.h>
 #include <RoBoRa_8833.h>
+#include <esp_timer.h>
 #include "config.h"
+#include "dblbuf.h"
+#include "lathist.h"
+#include "motortraj.h"
+#include "mixlut.h"
+
+/**
+ * @struct MotorsApplyStamp
+ * @brief Timing of the last setpoint of a move command applied by the control task.
+ *
+ * Timestamps are the low 32 bits of `esp_timer_get_time()` (microseconds,
+ * wrap after ~71 minutes): differences must be computed as `uint32_t`.
+ */
+typedef struct sMotorsApplyStamp
+{
+  uint16_t seq = 0;     ///< @brief Sequence number of the applied setpoint.
+  uint32_t postUs = 0;  ///< @brief When the setpoint was posted by `motorsPost()`.
+  uint32_t applyUs = 0; ///< @brief When the control task drove the outputs with it.
+} MotorsApplyStamp;
+
+/**
+ * @struct MotorsCtrlStats
+ * @brief Timing statistics of the motor control task.
+ *
+ * The jitter is the absolute difference between the measured wake-up period
+ * of the task and its nominal period (1 / `ctrlHz`).
+ */
+typedef struct sMotorsCtrlStats
+{
+  uint32_t ticks = 0;       ///< @brief Control periods since the last (re)start.
+  uint32_t periodUs = 0;    ///< @brief Nominal period.
+  uint32_t periodMinUs = 0; ///< @brief Shortest period.
+  uint32_t periodMaxUs = 0; ///< @brief Longest period.
+  uint32_t jitterAvgUs = 0; ///< @brief Mean jitter.
+  uint32_t jitterP99Us = 0; ///< @brief 99th percentile of the jitter (recent periods).
+  uint32_t jitterMaxUs = 0; ///< @brief Largest jitter.
+  uint32_t busyMaxUs = 0;   ///< @brief Longest time spent in one period.
+  uint32_t skipped = 0;     ///< @brief Periods skipped because a re-init held the control lock.
+  uint32_t wdTrips = 0;       ///< @brief Move deadlines missed with the motors running.
+  uint32_t wdDetectMaxUs = 0; ///< @brief Longest delay between a missed deadline and its detection.
+  uint32_t wdStopLastUs = 0;  ///< @brief Time from the last missed deadline to zero output (ramp included).
+  uint32_t wdStopMaxUs = 0;   ///< @brief Longest of @ref wdStopLastUs.
+} MotorsCtrlStats;
 
 /**
  * @brief Initializes the motor control system.
@@ -43,26 +86,67 @@ void motorsInit();
  * @brief Re-Initializesthe motor control system
  *
  * This function reads the motor configuration and sets up the hardware.
+ * A single parameter written with `configPut*()` does not need it: it is
+ * applied by `motorsTick()` with its own setter.
  */
 void motorsReload();
 
 /**
- * @brief Handles periodic motor updates.
+ * @brief Applies the changed motor parameters and handles the re-initialization
+ * requested by `motorsReload()`.
  *
- * This function should be called frequently within the main loop to ensure
- * motor commands are re-applied periodically.
+ * Called from the main loop. The outputs are driven by the control task, so
+ * a slow loop no longer stretches the motor update period.
  * @see motorsTick() in motors.cpp for implementation details.
  */
 void motorsTick();
 
 /**
- * @brief Applies new throttle and steering commands.
+ * @brief Sets new throttle and steering commands.
+ *
+ * The setpoint goes into the double buffer read by the control task, which
+ * drives the outputs at the next period.
  *
  * @param throttle The throttle value.
  * @param steer The steering value.
  */
 void motorsApply(int16_t throttle, int16_t steer);
 
+/**
+ * @brief Posts a new setpoint from a move command.
+ *
+ * Same as `motorsApply()`, but the setpoint carries the sequence number and
+ * the post time of the command: the control task reports them with
+ * `motorsGetAppliedSeq()` and `motorsGetApplyStamp()` when it applies it.
+ * Latest wins: bunched frames result in a single update with the newest values.
+ *
+ * @param throttle The throttle value.
+ * @param steer The steering value.
+ * @param seq The sequence number of the command (0 if the sender has none).
+ */
+void motorsPost(int16_t throttle, int16_t steer, uint16_t seq);
+
+/**
+ * @brief Gets the sequence number of the last setpoint applied from a move command.
+ *
+ * @return The last applied sequence number.
+ */
+uint16_t motorsGetAppliedSeq();
+
+/**
+ * @brief Gets the timing of the last setpoint applied from a move command.
+ *
+ * @return Sequence number, post and apply timestamps of the setpoint.
+ */
+MotorsApplyStamp motorsGetApplyStamp();
+
+/**
+ * @brief Gets the timing statistics of the motor control task.
+ *
+ * @return A copy of the statistics.
+ */
+MotorsCtrlStats motorsGetCtrlStats();
+
 /**
  * @brief Prints the current motor configuration to the serial port.
  */
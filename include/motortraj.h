@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2025 Orazio Franco <robora2025@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * @file motortraj.h
+ * @brief Setpoint interpolation and slew-rate limit of the motor control task.
+ *
+ * The UI sends a joystick vector every ~100 ms while the control task runs
+ * at `ctrlHz`. Instead of jumping to each new setpoint, the trajectory moves
+ * linearly from where it is to the new setpoint over the measured interval
+ * between setpoints (first-order hold, one interval of delay), then limits
+ * the rate of change of the output: `accel` while the output moves away from
+ * zero, `decel` while it moves towards zero. Both axes (throttle and steer)
+ * are handled the same way, in Q8 fixed point.
+ *
+ * The header only depends on the C library, it does no allocation and no
+ * locking: every trajectory must be updated by a single task.
+ */
+#pragma once
+#include <stdint.h>
+
+#define MOTOR_TRAJ_AXES 2                ///< Throttle and steer.
+#define MOTOR_TRAJ_INTERP_MAX_US 200000  ///< Setpoints further apart than this are not interpolated (first move, stalls).
+
+/**
+ * @struct MotorTraj
+ * @brief State of the trajectory, values in Q8 (256 = 1 unit of setpoint).
+ */
+typedef struct sMotorTraj
+{
+    int32_t out[MOTOR_TRAJ_AXES];  ///< @brief Current output.
+    int32_t from[MOTOR_TRAJ_AXES]; ///< @brief Start of the interpolation segment.
+    int32_t to[MOTOR_TRAJ_AXES];   ///< @brief Last setpoint, end of the segment.
+    uint32_t segStartUs;           ///< @brief Start time of the segment.
+    uint32_t segLenUs;             ///< @brief Length of the segment, 0 = step.
+    uint32_t lastSetUs;            ///< @brief Arrival time of the last setpoint (0 = none).
+    uint32_t intervalUs;           ///< @brief Mean interval between setpoints (0 = unknown).
+} MotorTraj;
+
+/**
+ * @brief Clears a trajectory: output and setpoint at zero.
+ * @param t The trajectory.
+ */
+static inline void motorTrajReset(MotorTraj *t)
+{
+    *t = MotorTraj();
+}
+
+/**
+ * @brief Position of the interpolation segment at a time.
+ *
+ * @param t The trajectory.
+ * @param axis The axis.
+ * @param nowUs The time.
+ * @return The interpolated setpoint, Q8.
+ */
+static inline int32_t motorTrajTarget(const MotorTraj *t, uint8_t axis, uint32_t nowUs)
+{
+    uint32_t el = nowUs - t->segStartUs;
+    if (t->segLenUs == 0 || el >= t->segLenUs)
+        return t->to[axis];
+    return t->from[axis] + (int32_t)((int64_t)(t->to[axis] - t->from[axis]) * el / t->segLenUs);
+}
+
+/**
+ * @brief Sets a new setpoint.
+ *
+ * @param t The trajectory.
+ * @param throttle The throttle.
+ * @param steer The steer.
+ * @param nowUs Arrival time of the setpoint.
+ * @param interp Interpolate from the current position (otherwise step, only slew limited).
+ */
+static inline void motorTrajSet(MotorTraj *t, int16_t throttle, int16_t steer, uint32_t nowUs, bool interp)
+{
+    uint32_t dt = t->lastSetUs ? nowUs - t->lastSetUs : 0;
+    bool regular = dt && dt <= MOTOR_TRAJ_INTERP_MAX_US;
+    if (regular)
+        t->intervalUs = t->intervalUs ? (3 * t->intervalUs + dt) / 4 : dt;
+    for (uint8_t i = 0; i < MOTOR_TRAJ_AXES; i++)
+        t->from[i] = motorTrajTarget(t, i, nowUs);
+    t->to[0] = (int32_t)throttle * 256;
+    t->to[1] = (int32_t)steer * 256;
+    t->segStartUs = nowUs;
+    t->segLenUs = (interp && regular) ? t->intervalUs : 0;
+    t->lastSetUs = nowUs;
+}
+
+/**
+ * @brief Advances the output by one control period.
+ *
+ * @param t The trajectory.
+ * @param nowUs Time of the period.
+ * @param dtUs Time since the previous period.
+ * @param accel Largest change per second moving away from zero, setpoint units (0 = no limit).
+ * @param decel Largest change per second moving towards zero, setpoint units (0 = no limit).
+ * @param out The new output, throttle and steer.
+ */
+static inline void motorTrajStep(MotorTraj *t, uint32_t nowUs, uint32_t dtUs, uint16_t accel, uint16_t decel, int16_t out[MOTOR_TRAJ_AXES])
+{
+    for (uint8_t i = 0; i < MOTOR_TRAJ_AXES; i++)
+    {
+        int32_t target = motorTrajTarget(t, i, nowUs);
+        int32_t cur = t->out[i];
+        int32_t diff = target - cur;
+        // verso lo zero (o oltre) = decelerazione, lontano dallo zero = accelerazione
+        bool towardZero = (cur > 0 && diff < 0) || (cur < 0 && diff > 0);
+        uint16_t rate = towardZero ? decel : accel;
+        if (rate)
+        {
+            int32_t step = (int32_t)((uint64_t)rate * 256 * dtUs / 1000000);
+            if (step < 1)
+                step = 1;
+            if (towardZero && (cur > 0 ? target < 0 : target > 0))
+                target = 0; // attraversa lo zero: prima si ferma con decel
+            if (target - cur > step)
+                target = cur + step;
+            else if (cur - target > step)
+                target = cur - step;
+        }
+        t->out[i] = target;
+        out[i] = (int16_t)((target + (target >= 0 ? 128 : -128)) / 256);
+    }
+}
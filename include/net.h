@@ -30,6 +30,7 @@
 #include <ESPAsyncWebServer.h>
 #include "config.h"
 #include "display.h"
+#include "blackbox.h"
 
 /// @brief Global instance of the web server.
 ///
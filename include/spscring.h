@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2025 Orazio Franco <robora2025@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * @file spscring.h
+ * @brief Lock-free single-producer single-consumer ring buffer.
+ *
+ * One task (or ISR-driven task) pushes, another one pops, without any lock:
+ * the producer only writes `head`, the consumer only writes `tail`, and the
+ * acquire/release ordering makes the element visible before its index.
+ * When the ring is full the new element is rejected (the producer cannot
+ * overwrite a slot the consumer may be reading) and counted as dropped.
+ *
+ * The header only depends on the C++ standard library so it can also be
+ * built on the host.
+ */
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+/**
+ * @class SpscRing
+ * @brief Fixed-size SPSC ring of @p N elements of type @p T.
+ *
+ * @tparam T Element type, copied by value.
+ * @tparam N Capacity, must be a power of two.
+ */
+template <typename T, size_t N>
+class SpscRing
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing size must be a power of two");
+
+public:
+    /**
+     * @brief Appends an element (producer side).
+     * @param v The element.
+     * @return false if the ring is full and the element was dropped.
+     */
+    bool push(const T &v)
+    {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        uint32_t t = tail.load(std::memory_order_acquire);
+        if (h - t >= N)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        buf[h & (N - 1)] = v;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest element (consumer side).
+     * @param v Receives the element.
+     * @return false if the ring is empty.
+     */
+    bool pop(T &v)
+    {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        uint32_t h = head.load(std::memory_order_acquire);
+        if (h == t)
+            return false;
+        v = buf[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Discards all the queued elements (consumer side).
+     */
+    void clear() { tail.store(head.load(std::memory_order_acquire), std::memory_order_release); }
+
+    /**
+     * @brief Number of queued elements (approximate if called by a third task).
+     * @return The number of elements.
+     */
+    size_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Number of elements rejected because the ring was full.
+     * @return The drop counter.
+     */
+    uint32_t drops() const { return dropped.load(std::memory_order_relaxed); }
+
+    /// @brief Capacity of the ring.
+    static constexpr size_t capacity = N;
+
+private:
+    T buf[N];                          ///< @brief Storage.
+    std::atomic<uint32_t> head{0};     ///< @brief Next slot to write, owned by the producer.
+    std::atomic<uint32_t> tail{0};     ///< @brief Next slot to read, owned by the consumer.
+    std::atomic<uint32_t> dropped{0};  ///< @brief Elements rejected because the ring was full.
+};
@@ -31,13 +31,59 @@
 #pragma once
 #include <Arduino.h>
 #include <Wire.h>
+#include <stdarg.h>
 #include <RobOra_42670.h>
 #include "config.h"
 #include "websocket.h"
+#include "wsproto.h"
+#include "lathist.h"
+#include "spscring.h"
+#include "imufifo.h"
+#include "attitude.h"
+#include "adccont.h"
+#include "aggstat.h"
+#include "blackbox.h"
 
 /// @brief Variable to store the latest IMU data frame.
 extern _sRobOra_42670_IMU imuFrame;
 
+/**
+ * @struct ImuSample
+ * @brief One IMU reading of the acquisition task.
+ */
+typedef struct sImuSample
+{
+  uint32_t tUs;              ///< @brief `esp_timer_get_time()` at the start of the read, low 32 bits.
+  _sRobOra_42670_IMU frame;  ///< @brief The reading.
+  int16_t q[4];              ///< @brief Attitude quaternion w, x, y, z (Q14) in FIFO mode, all 0 in register mode.
+} ImuSample;
+
+/**
+ * @struct ImuStats
+ * @brief Timing statistics of the IMU acquisition task.
+ *
+ * The jitter is the absolute difference between the measured wake-up period
+ * of the task and its nominal period (@ref IMU_SAMPLE_PERIOD_US, or
+ * @ref IMU_FIFO_DRAIN_US in FIFO mode).
+ */
+typedef struct sImuStats
+{
+  uint32_t samples = 0;     ///< @brief Task wake-ups (reads or FIFO drains) since the last (re)start.
+  uint32_t dropped = 0;     ///< @brief Samples lost because the ring was full.
+  uint32_t periodMinUs = 0; ///< @brief Shortest sample period.
+  uint32_t periodMaxUs = 0; ///< @brief Longest sample period.
+  uint32_t jitterAvgUs = 0; ///< @brief Mean jitter.
+  uint32_t jitterP99Us = 0; ///< @brief 99th percentile of the jitter (recent samples).
+  uint32_t jitterMaxUs = 0; ///< @brief Largest jitter.
+} ImuStats;
+
+/**
+ * @brief Gets the timing statistics of the IMU acquisition task.
+ *
+ * @return A copy of the statistics.
+ */
+ImuStats telemetryGetImuStats();
+
 /**
  * @brief Initializes the IMU and telemetry systems.
  *
@@ -55,7 +101,9 @@ void telemetryTick();
 /**
  * @brief Re-Initializes the IMU and telemetry systems
  *
- * This function sets up the I2C bus and re-initializes the IMU sensor
+ * This function sets up the I2C bus and re-initializes the IMU sensor.
+ * Single parameters written with `configPut*()` are applied incrementally
+ * by `telemetryTick()`; only "enable", "fifo" and "odr" re-initialize the IMU.
  */
 void telemetryReload();
 
@@ -73,4 +121,42 @@ void telemetryReload();
  * @param Pin The GPIO pin number (uint8_t) configured as an analog input 
  * @return float The actual voltage measured at the source (V_in), in Volts.
  */
-float telemetryReadAdC(uint8_t Pin);
\ No newline at end of file
+float telemetryReadAdC(uint8_t Pin);
+
+/// @brief All the change-detected telemetry channels (`sens0..sens4`).
+#define TELE_CH_ALL ((uint8_t)((1u << TELE_DELTA_CHANNELS) - 1))
+
+/**
+ * @brief Generates the JSON telemetry message (`{"CMD":"sensor",...}`).
+ *
+ * @param mask Channels `sens0..sens4` to include; anything but @ref TELE_CH_ALL
+ *             gives a delta message (`"delta":1`).
+ * @param alarm Active alarms (@ref WsSensorAlarm), sent as "alarm" when not 0.
+ * @param agg Window aggregates of `sens0..sens3` to send as "agg", nullptr = none.
+ * @return The JSON string.
+ */
+String telemetrySensorString(uint8_t mask = TELE_CH_ALL, uint8_t alarm = 0, const AggStat *agg = nullptr);
+
+/**
+ * @brief Size of the history frame with the samples currently in the ring.
+ *
+ * @return The size in bytes of the @ref WsBinSensorHist frame, 0 if the history is off or empty.
+ */
+size_t telemetryHistorySize();
+
+/**
+ * @brief Builds the history frame, oldest sample first.
+ *
+ * Call from the loop task (the ring is written by `telemetryTick()`).
+ * @param buf Destination.
+ * @param max Size of `buf`; records that do not fit are left out (the oldest).
+ * @return The frame length in bytes, 0 if there is nothing to send.
+ */
+size_t telemetryHistoryFrame(uint8_t *buf, size_t max);
+
+/**
+ * @brief Fills the binary telemetry frame, same channels as `telemetrySensorString()`.
+ *
+ * @param f The frame to fill.
+ */
+void telemetrySensorFrame(WsBinSensor &f);
\ No newline at end of file
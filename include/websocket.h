@@ -25,10 +25,9 @@
  *
  * This file defines the public interface for the WebSocket module.
  * It includes the declaration for the function that initializes the
- * WebSocket server and includes the command map.
+ * WebSocket server and includes the command table.
  */
 #pragma once
-#include <map>
 #include <ArduinoJson.h>
 #include <WiFi.h>
 #include "config.h"
@@ -37,7 +36,52 @@
 #include "telemetry.h"
 #include "functionkeys.h" 
 #include "display.h"
-#include <FifoStringDyn.h>
+#include "wsproto.h"
+#include "wscmdtable.h"
+#include "jsonarena.h"
+#include "lathist.h"
+#include "clocksync.h"
+#include "wsoutq.h"
+
+/**
+ * @enum WsPrio
+ * @brief Priority classes of the per-client outbound queues.
+ *
+ * Lower value = higher priority. Each client has one bounded queue per class
+ * and they are drained highest priority first.
+ */
+enum WsPrio : uint8_t
+{
+  WS_PRIO_CONTROL = 0, ///< Command replies and acks.
+  WS_PRIO_EVENT,       ///< OTA progress and other events; drops the oldest when full.
+  WS_PRIO_TELEMETRY,   ///< Sensor frames; a new frame replaces the one of the same kind not yet sent.
+  WS_PRIO_COUNT
+};
+
+/**
+ * @enum WsTopic
+ * @brief Broadcast topics a client can subscribe to.
+ *
+ * The values are bit positions of the per-client subscription mask. A new
+ * client is subscribed to every topic, so legacy clients keep receiving all
+ * the broadcasts.
+ */
+enum WsTopic : uint8_t
+{
+  WS_TOPIC_SENSOR = 0, ///< Telemetry frames ("sensor").
+  WS_TOPIC_OTA,        ///< OTA progress and result ("ota").
+  WS_TOPIC_DISPLAY,    ///< Text shown on the display ("display").
+  WS_TOPIC_LOG,        ///< Firmware log lines ("log").
+  WS_TOPIC_ATTITUDE,   ///< Attitude quaternion stream, binary only ("attitude").
+  WS_TOPIC_COUNT
+};
+
+/// @brief Subscription mask with every topic.
+#define WS_TOPIC_ALL_MASK ((uint8_t)((1u << WS_TOPIC_COUNT) - 1))
+/// @brief Topics that also have a binary format (see `wsproto.h`).
+#define WS_TOPIC_BIN_MASK ((uint8_t)((1u << WS_TOPIC_SENSOR) | (1u << WS_TOPIC_ATTITUDE)))
+/// @brief Topics that only have the binary format: subscribing selects it.
+#define WS_TOPIC_BIN_ONLY_MASK ((uint8_t)(1u << WS_TOPIC_ATTITUDE))
 
 
 /**
@@ -66,8 +110,99 @@ bool websocketAreClients(void);
  * @brief Secure load queue message for sending via web server .
  *
  * This function queues messages to be sent asynchronously
- * but in a controlled manner through the web server.
+ * but in a controlled manner through the web server: the message goes on the
+ * bounded outbound queue of every client, with the given priority class.
  * @param msg The message push.
+ * @param prio The priority class of the message.
  * @return The boolean value of correct push.
  */
-bool websocketAsyncMsg(const String &msg);
\ No newline at end of file
+bool websocketAsyncMsg(const String &msg, WsPrio prio = WS_PRIO_EVENT);
+
+/**
+ * @brief Queues a message for the subscribers of a topic.
+ *
+ * Only the clients subscribed to @p topic in JSON format get the message, and a client
+ * that asked for a maximum rate on the topic skips the messages published
+ * before its minimum interval has elapsed. Sensor frames use the telemetry
+ * queue, the other topics the event queue.
+ *
+ * On a paced topic (see `websocketSetTopicPeriod()`) the producer publishes
+ * once per period group instead: with @p periodMs only the clients with that
+ * period get the message, and the rate limit does not apply.
+ * @param topic The topic of the message.
+ * @param msg The message to publish.
+ * @param periodMs Only the clients with this period, 0 = every subscriber.
+ * @param delta True for a message that only carries what changed: it never
+ * replaces (or is replaced by) a full message in a client queue, and if a
+ * client loses it `websocketTakeNewSubscribers()` asks for a full message.
+ * @return true if at least one client got the message.
+ */
+bool websocketPublish(WsTopic topic, const String &msg, uint16_t periodMs = 0, bool delta = false);
+
+/**
+ * @brief Queues a binary frame for the subscribers of a topic.
+ *
+ * Same as `websocketPublish()` for the clients that selected the binary
+ * format of the topic.
+ * @param topic The topic of the frame.
+ * @param data The frame bytes.
+ * @param len Length of the frame.
+ * @param periodMs Only the clients with this period, 0 = every subscriber.
+ * @param delta True for a delta frame (see `websocketPublish()`).
+ * @return true if at least one client got the frame.
+ */
+bool websocketPublishBin(WsTopic topic, const void *data, size_t len, uint16_t periodMs = 0, bool delta = false);
+
+/**
+ * @brief Checks if any connected client is subscribed to a topic in a format.
+ *
+ * Lets the producers skip building a message nobody will receive, and build
+ * each format at most once per publication.
+ * @param topic The topic to check.
+ * @param binary true to check the binary format, false for JSON.
+ * @param periodMs Only the clients with this period (paced topics), 0 = any.
+ * @return true if at least one client is subscribed.
+ */
+bool websocketHasSubscribers(WsTopic topic, bool binary = false, uint16_t periodMs = 0);
+
+/**
+ * @brief Makes a topic paced, with a default period.
+ *
+ * Each subscriber of a paced topic has its own period: the one it asked
+ * with the "hz" of the "sub" command (at most @ref WS_RATE_MAX_HZ), or
+ * @p defMs. The producer sends one message per distinct period (see
+ * `websocketTopicPeriods()`).
+ * @param topic The topic.
+ * @param defMs Period of the clients that did not ask for a rate, 0 = not paced.
+ */
+void websocketSetTopicPeriod(WsTopic topic, uint16_t defMs);
+
+/**
+ * @brief Lists the distinct periods of the subscribers of a paced topic.
+ *
+ * @param topic The topic.
+ * @param periods Output, one entry per distinct period.
+ * @param max Size of @p periods.
+ * @return The number of distinct periods.
+ */
+uint8_t websocketTopicPeriods(WsTopic topic, uint16_t *periods, uint8_t max);
+
+/**
+ * @brief Checks and clears the "new subscriber" flag of a topic.
+ *
+ * Producers that only send what changed use it to send a full message as
+ * soon as a client connects or (re)subscribes, or drops one of their delta
+ * messages from its queue, instead of waiting for the next keyframe.
+ * @param topic The topic.
+ * @return true if a client subscribed (or connected) since the last call.
+ */
+bool websocketTakeNewSubscribers(WsTopic topic);
+
+/**
+ * @brief Publishes a log line on the @ref WS_TOPIC_LOG topic.
+ *
+ * The message is `{"CMD":"log","msg":...}`; nothing is built if no client is
+ * subscribed to the topic.
+ * @param text The log line.
+ */
+void websocketLog(const String &text);
\ No newline at end of file
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2025 Orazio Franco <robora2025@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * @file wscmdtable.h
+ * @brief Compile-time perfect-hash table for WebSocket command dispatch.
+ *
+ * The table maps a command name (`const char *`) to its handler without any
+ * heap allocation: it is built at compile time from a constant array of
+ * @ref WsCmdEntry, the bucket index is computed with a seeded FNV-1a hash and
+ * the seed is searched at compile time so that every command lands in its
+ * own bucket. A lookup is one hash, one array access and one `strcmp`.
+ *
+ * The header only depends on the C library so it can also be built on the
+ * host (see `bench/ws_dispatch_bench.cpp`).
+ */
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * @brief Seeded FNV-1a hash of a zero-terminated string.
+ *
+ * The result is folded so that the low bits, used as bucket index, depend on
+ * the whole hash.
+ *
+ * @param s The string to hash.
+ * @param seed Value mixed into the offset basis.
+ * @return The 32-bit hash.
+ */
+constexpr uint32_t wsCmdHash(const char *s, uint32_t seed = 0)
+{
+    uint32_t h = 2166136261u ^ seed;
+    while (*s)
+    {
+        h ^= (uint8_t)*s++;
+        h *= 16777619u;
+    }
+    return h ^ (h >> 16); // fold the high bits: the low bits of FNV-1a only depend on the low bits of the input
+}
+
+/** @name Command entry flags
+ * @{ */
+#define WS_CMD_F_NONE 0x00   ///< No special handling.
+#define WS_CMD_F_NOARGS 0x01 ///< The command takes no payload and can be invoked by ID from a binary frame.
+/** @} */
+
+/**
+ * @struct WsCmdEntry
+ * @brief One command of the dispatch table.
+ * @tparam H Handler type (function pointer).
+ */
+template <typename H>
+struct WsCmdEntry
+{
+    const char *name; ///< @brief Command name, value of the JSON "CMD" key.
+    uint8_t id;       ///< @brief Integer command ID, used by binary frames.
+    uint8_t flags;    ///< @brief Combination of `WS_CMD_F_*`.
+    H handler;        ///< @brief Function called for the command.
+};
+
+/**
+ * @struct WsCmdTable
+ * @brief Perfect-hash table built by @ref wsCmdMakeTable.
+ * @tparam H Handler type (function pointer).
+ * @tparam N Number of commands.
+ * @tparam B Number of buckets, power of two and not smaller than @p N.
+ */
+template <typename H, size_t N, size_t B>
+struct WsCmdTable
+{
+    static_assert((B & (B - 1)) == 0, "bucket count must be a power of two");
+    static_assert(N <= B && N < 255, "too many commands for the bucket count");
+
+    WsCmdEntry<H> entries[N]; ///< @brief The commands, in declaration order.
+    uint8_t bucket[B];        ///< @brief Bucket -> entry index + 1 (0 = empty).
+    uint8_t byId[256];        ///< @brief Command ID -> entry index + 1 (0 = unknown).
+    uint32_t seed;            ///< @brief Hash seed that makes the table collision free.
+    bool perfect;             ///< @brief True if a collision free seed was found.
+
+    /**
+     * @brief Looks up a command by name.
+     * @param name The command name.
+     * @return Pointer to the entry, or nullptr if unknown.
+     */
+    const WsCmdEntry<H> *find(const char *name) const
+    {
+        uint8_t i = bucket[wsCmdHash(name, seed) & (B - 1)];
+        if (i == 0 || strcmp(entries[i - 1].name, name) != 0)
+            return nullptr;
+        return &entries[i - 1];
+    }
+
+    /**
+     * @brief Looks up a command by integer ID.
+     * @param id The command ID.
+     * @return Pointer to the entry, or nullptr if unknown.
+     */
+    const WsCmdEntry<H> *findId(uint8_t id) const
+    {
+        uint8_t i = byId[id];
+        return i ? &entries[i - 1] : nullptr;
+    }
+};
+
+/**
+ * @brief Builds a perfect-hash table at compile time.
+ *
+ * Seeds are tried in order until all the command names map to distinct
+ * buckets; the caller should `static_assert` on @ref WsCmdTable::perfect.
+ *
+ * @tparam B Number of buckets.
+ * @param list The commands.
+ * @return The table.
+ */
+template <size_t B, typename H, size_t N>
+constexpr WsCmdTable<H, N, B> wsCmdMakeTable(const WsCmdEntry<H> (&list)[N])
+{
+    WsCmdTable<H, N, B> t{};
+    for (size_t i = 0; i < N; ++i)
+    {
+        t.entries[i] = list[i];
+        t.byId[list[i].id] = (uint8_t)(i + 1);
+    }
+    for (uint32_t seed = 0; seed < 4096; ++seed)
+    {
+        bool ok = true;
+        for (size_t b = 0; b < B; ++b)
+            t.bucket[b] = 0;
+        for (size_t i = 0; i < N && ok; ++i)
+        {
+            size_t b = wsCmdHash(list[i].name, seed) & (B - 1);
+            if (t.bucket[b] != 0)
+                ok = false;
+            else
+                t.bucket[b] = (uint8_t)(i + 1);
+        }
+        if (ok)
+        {
+            t.seed = seed;
+            t.perfect = true;
+            return t;
+        }
+    }
+    t.perfect = false;
+    return t;
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2025 Orazio Franco <robora2025@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * @file wsoutq.h
+ * @brief Bounded outbound queues of the WebSocket clients.
+ *
+ * One ring of fixed slots per priority class. When a ring is full the oldest
+ * message is dropped. In a coalescing ring (telemetry) a new message replaces
+ * the queued one of the same kind instead, so a slow client gets the newest
+ * frame of each kind.
+ *
+ * A delta frame only carries what changed since the previous one, so losing
+ * it leaves the client with stale values until the next full frame. Every
+ * message has a resync mask (topics, bit `1 << WsTopic`, 0 for full frames):
+ * when a message is replaced or dropped its mask is returned to the caller,
+ * which asks the producer of those topics for a full frame. Delta frames and
+ * full frames of the same kind never replace each other.
+ *
+ * The header only depends on the C library so it can also be built on the
+ * host (see `test/test_wsoutq`). The caller serializes the accesses.
+ */
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "all_define.h"
+
+/**
+ * @struct WsOutMsg
+ * @brief One queued outbound message.
+ */
+typedef struct sWsOutMsg
+{
+  uint16_t len = 0;                  ///< @brief Number of bytes in @ref data.
+  bool binary = false;               ///< @brief True for a binary frame, false for text.
+  uint8_t key = 0;                   ///< @brief Kind of telemetry frame (topic, or opcode of a binary frame).
+  uint8_t resync = 0;                ///< @brief Topics to resync if the message is lost (delta frames), 0 = none.
+  char data[WS_OUTQ_SLOT_SIZE];      ///< @brief Message bytes (not null-terminated).
+} WsOutMsg;
+
+/**
+ * @struct WsOutRing
+ * @brief Bounded ring of @ref WsOutMsg for one priority class.
+ */
+typedef struct sWsOutRing
+{
+  WsOutMsg *slots; ///< @brief Storage of the ring.
+  uint8_t depth;   ///< @brief Number of slots.
+  uint8_t head;    ///< @brief Index of the oldest message.
+  uint8_t count;   ///< @brief Number of queued messages.
+} WsOutRing;
+
+/**
+ * @brief Queues a message.
+ *
+ * @param r The ring.
+ * @param data The message bytes.
+ * @param len The message length, at most @ref WS_OUTQ_SLOT_SIZE.
+ * @param binary True for a binary frame.
+ * @param key Kind of the message, used when @p coalesce is set.
+ * @param resync Topics to resync if this message is lost, 0 for a full frame.
+ * @param coalesce True to replace the queued message with the same @p key and
+ * the same kind of frame (delta or full).
+ * @param lost Receives the resync mask of the replaced or dropped message.
+ * @return false if a queued message was replaced or dropped.
+ */
+static inline bool wsOutQPush(WsOutRing *r, const void *data, size_t len, bool binary, uint8_t key, uint8_t resync,
+                              bool coalesce, uint8_t *lost)
+{
+  WsOutMsg *m = nullptr;
+  if (coalesce)
+  {
+    for (uint8_t i = 0; i < r->count && !m; i++)
+    {
+      WsOutMsg &q = r->slots[(r->head + i) % r->depth];
+      if (q.key == key && (q.resync != 0) == (resync != 0))
+        m = &q;
+    }
+  }
+  bool kept = !m;
+  *lost = m ? m->resync : 0;
+  if (!m)
+  {
+    if (r->count == r->depth)
+    {
+      *lost = r->slots[r->head].resync;
+      r->head = (r->head + 1) % r->depth;
+      r->count--;
+      kept = false;
+    }
+    m = &r->slots[(r->head + r->count) % r->depth];
+    r->count++;
+  }
+  memcpy(m->data, data, len);
+  m->len = (uint16_t)len;
+  m->binary = binary;
+  m->key = key;
+  m->resync = resync;
+  return kept;
+}
+
+/**
+ * @brief Extracts the oldest message.
+ * @param r The ring.
+ * @param out Where the message is copied.
+ * @return false if the ring is empty.
+ */
+static inline bool wsOutQPop(WsOutRing *r, WsOutMsg *out)
+{
+  if (!r->count)
+    return false;
+  const WsOutMsg &m = r->slots[r->head];
+  memcpy(out->data, m.data, m.len);
+  out->len = m.len;
+  out->binary = m.binary;
+  out->key = m.key;
+  out->resync = m.resync;
+  r->head = (r->head + 1) % r->depth;
+  r->count--;
+  return true;
+}
+
+/**
+ * @brief Empties a ring.
+ * @param r The ring.
+ */
+static inline void wsOutQClear(WsOutRing *r)
+{
+  r->head = 0;
+  r->count = 0;
+}
@@ -0,0 +1,343 @@
+/*
+ * Copyright (c) 2025 Orazio Franco <robora2025@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * @file wsproto.h
+ * @brief Binary WebSocket frame layouts shared by the firmware modules.
+ *
+ * This file defines the compact, fixed-size binary frames exchanged over the
+ * WebSocket next to the JSON protocol. Every frame starts with a @ref WsBinHdr
+ * and all multi-byte fields are little-endian (native on ESP32 and on the
+ * browser side when read with `DataView(..., true)`).
+ */
+#pragma once
+#include <stdint.h>
+
+/**
+ * @def WS_BIN_PROTO_VER
+ * @brief Version of the binary frame layout, advertised in `hello_webui` as "bin".
+ */
+#define WS_BIN_PROTO_VER 1
+
+/**
+ * @enum WsBinOp
+ * @brief Opcodes of the binary frames (first byte of every frame).
+ *
+ * Opcodes with the high bit set travel from the ESP32 to the client.
+ */
+enum WsBinOp : uint8_t
+{
+    WS_BIN_OP_MOVE = 0x01, ///< Client -> ESP32: throttle/steer setpoint (@ref WsBinMove).
+    WS_BIN_OP_CMD = 0x02,  ///< Client -> ESP32: payload-less command by ID (@ref WsBinCmd).
+    WS_BIN_OP_PING = 0x03, ///< Client -> ESP32: latency probe (@ref WsBinPing).
+    WS_BIN_OP_SYNC = 0x04, ///< Client -> ESP32: clock synchronization exchange (@ref WsBinSync).
+    WS_BIN_OP_ACK = 0x81,  ///< ESP32 -> client: acknowledge of a frame (@ref WsBinAck).
+    WS_BIN_OP_PONG = 0x83, ///< ESP32 -> client: answer to a ping with the firmware timestamps (@ref WsBinPong).
+    WS_BIN_OP_SENSOR = 0x84, ///< ESP32 -> client: telemetry frame, binary form of the JSON `sensor` (@ref WsBinSensor).
+    WS_BIN_OP_SENSOR_AGG = 0x85, ///< ESP32 -> client: window aggregates of the telemetry channels (@ref WsBinSensorAgg).
+    WS_BIN_OP_SENSOR_DELTA = 0x86, ///< ESP32 -> client: only the telemetry channels that changed (@ref WsBinSensorDelta).
+    WS_BIN_OP_ATTITUDE = 0x87, ///< ESP32 -> client: attitude quaternion, "attitude" topic (@ref WsBinAttitude).
+    WS_BIN_OP_SENSOR_HIST = 0x88, ///< ESP32 -> client: recent telemetry history, sent on subscribe (@ref WsBinSensorHist).
+    WS_BIN_OP_SYNC_REPLY = 0x89, ///< ESP32 -> client: answer to a sync with the offset/drift estimate (@ref WsBinSyncReply).
+};
+
+/**
+ * @enum WsCmdId
+ * @brief Integer IDs of the WebSocket commands, usable in @ref WsBinCmd.
+ *
+ * The values are part of the protocol: append new commands, never renumber.
+ */
+enum WsCmdId : uint8_t
+{
+    WS_CMD_HELLO = 0,
+    WS_CMD_REBOOT = 1,
+    WS_CMD_CONFIG_REQ = 2,
+    WS_CMD_CONFIG_RD = 3,
+    WS_CMD_CONFIG_WR = 4,
+    WS_CMD_INFO_REQ = 5,
+    WS_CMD_MOVE = 6,
+    WS_CMD_FUNCTION = 7,
+    WS_CMD_RESET_MEMORY = 8,
+    WS_CMD_DISPLAYMSG = 9,
+    WS_CMD_PING = 10,
+    WS_CMD_SUB = 11,
+    WS_CMD_UNSUB = 12,
+    WS_CMD_BLACKBOX = 13,
+    WS_CMD_SYNC = 14,
+};
+
+/** @name Binary move flags
+ * @{ */
+#define WS_BIN_FLAG_ACK 0x01 ///< The client asks for a @ref WsBinAck of this frame.
+/** @} */
+
+/** @name Binary ack status
+ * @{ */
+#define WS_BIN_ACK_OK 0x00    ///< Frame applied.
+#define WS_BIN_ACK_ERROR 0x01 ///< Frame rejected (bad length or value).
+#define WS_BIN_ACK_STALE 0x02 ///< Frame dropped, its sequence number is older than the last accepted one.
+/** @} */
+
+/**
+ * @struct sWsBinHdr
+ * @brief Common header of every binary frame.
+ */
+typedef struct __attribute__((packed)) sWsBinHdr
+{
+    uint8_t op;   ///< @brief Frame opcode (@ref WsBinOp).
+    uint8_t ver;  ///< @brief Layout version (@ref WS_BIN_PROTO_VER).
+    uint16_t seq; ///< @brief Sender sequence number, wraps at 65535.
+} WsBinHdr;
+
+/**
+ * @struct sWsBinMove
+ * @brief Drive setpoint, same meaning as the JSON `move` command (`y=throttle`, `x=steer`).
+ */
+typedef struct __attribute__((packed)) sWsBinMove
+{
+    WsBinHdr hdr;     ///< @brief Header, `op` = @ref WS_BIN_OP_MOVE.
+    int8_t throttle;  ///< @brief Throttle, -127..127.
+    int8_t steer;     ///< @brief Steer, -127..127.
+    uint8_t flags;    ///< @brief Combination of `WS_BIN_FLAG_*`.
+    uint8_t reserved; ///< @brief Reserved, send 0.
+} WsBinMove;
+
+/**
+ * @struct sWsBinCmd
+ * @brief Invokes a command that takes no payload (e.g. `info_req`) by its @ref WsCmdId.
+ */
+typedef struct __attribute__((packed)) sWsBinCmd
+{
+    WsBinHdr hdr;     ///< @brief Header, `op` = @ref WS_BIN_OP_CMD.
+    uint8_t cmd;      ///< @brief The @ref WsCmdId.
+    uint8_t reserved; ///< @brief Reserved, send 0.
+} WsBinCmd;
+
+/**
+ * @struct sWsBinAck
+ * @brief Acknowledge of a binary frame, echoes the sequence number of the request.
+ */
+typedef struct __attribute__((packed)) sWsBinAck
+{
+    WsBinHdr hdr;     ///< @brief Header, `op` = @ref WS_BIN_OP_ACK, `seq` of the acknowledged frame.
+    uint8_t reqOp;    ///< @brief Opcode of the acknowledged frame.
+    uint8_t status;   ///< @brief `WS_BIN_ACK_*` status.
+} WsBinAck;
+
+/**
+ * @struct sWsBinPing
+ * @brief Latency probe, same meaning as the JSON `ping` command.
+ */
+typedef struct __attribute__((packed)) sWsBinPing
+{
+    WsBinHdr hdr; ///< @brief Header, `op` = @ref WS_BIN_OP_PING.
+    uint32_t t;   ///< @brief Client timestamp, echoed back in the pong.
+    uint32_t rtt; ///< @brief Round trip time of the previous ping measured by the client, in us (0 = none).
+} WsBinPing;
+
+/**
+ * @struct sWsBinPong
+ * @brief Answer to @ref WsBinPing.
+ *
+ * ESP32 timestamps are the low 32 bits of `esp_timer_get_time()`, compare
+ * them only with each other using unsigned 32-bit differences.
+ */
+typedef struct __attribute__((packed)) sWsBinPong
+{
+    WsBinHdr hdr;      ///< @brief Header, `op` = @ref WS_BIN_OP_PONG, `seq` of the ping.
+    uint32_t t;        ///< @brief Client timestamp of the ping.
+    uint32_t rx;       ///< @brief ESP32 time (us) of the first chunk of the ping.
+    uint32_t disp;     ///< @brief ESP32 time (us) when the ping reached its handler.
+    uint32_t apply;    ///< @brief ESP32 time (us) when the control task applied the last move setpoint.
+    uint32_t lag;      ///< @brief Time (us) that setpoint waited before the control task applied it.
+    uint16_t aseq;     ///< @brief Sequence number of that setpoint.
+    uint16_t reserved; ///< @brief Reserved, 0.
+} WsBinPong;
+
+/**
+ * @struct sWsBinSync
+ * @brief Clock synchronization request, same meaning as the JSON `sync` command.
+ *
+ * Client timestamps are microseconds of the client clock (the web UI uses
+ * the Unix epoch). The client reports when the previous reply arrived, so
+ * the robot can close that exchange with its four NTP timestamps.
+ */
+typedef struct __attribute__((packed)) sWsBinSync
+{
+    WsBinHdr hdr;   ///< @brief Header, `op` = @ref WS_BIN_OP_SYNC.
+    int64_t t1;     ///< @brief Client send time of this request, us.
+    int64_t prevT1; ///< @brief `t1` of the previous request (0 = none).
+    int64_t prevT4; ///< @brief Client receive time of the reply to the previous request, us (0 = none).
+} WsBinSync;
+
+/**
+ * @struct sWsBinSyncReply
+ * @brief Answer to @ref WsBinSync.
+ *
+ * ESP32 timestamps are `esp_timer_get_time()`, the clock of `millis()` and
+ * of the telemetry. A client time `c` is the robot time
+ * `c + offset + drift * (c + offset - t2) / 1e9`.
+ */
+typedef struct __attribute__((packed)) sWsBinSyncReply
+{
+    WsBinHdr hdr;     ///< @brief Header, `op` = @ref WS_BIN_OP_SYNC_REPLY, `seq` of the request.
+    int64_t t1;       ///< @brief Client send time of the request.
+    int64_t t2;       ///< @brief ESP32 time (us) of the first chunk of the request.
+    int64_t t3;       ///< @brief ESP32 time (us) when the reply was built.
+    int64_t offset;   ///< @brief Estimated offset at `t2`, robot minus client, us (0 until the first exchange closes).
+    int32_t driftPpb; ///< @brief Slope of the offset, ppb (0 until the baseline is long enough).
+    uint32_t delayUs; ///< @brief Round trip delay of the sample behind the estimate, us.
+} WsBinSyncReply;
+
+/**
+ * @struct sWsBinSensor
+ * @brief Telemetry frame, same channels as the JSON `sensor` message.
+ *
+ * Values are fixed point: angles in hundredths of degree, temperature in
+ * hundredths of degree Celsius, battery in millivolts.
+ */
+typedef struct __attribute__((packed)) sWsBinSensor
+{
+    WsBinHdr hdr;        ///< @brief Header, `op` = @ref WS_BIN_OP_SENSOR, `seq` = frame counter.
+    uint32_t ms;         ///< @brief ESP32 `millis()` of the frame (`sens7`).
+    int16_t angle[3];    ///< @brief Pitch, roll, yaw (`sens0..2`), 0.01 deg.
+    int16_t temp;        ///< @brief IMU temperature (`sens3`), 0.01 C.
+    uint16_t battery;    ///< @brief Battery voltage (`sens4`), mV.
+    uint16_t aseq;       ///< @brief Sequence number of the last applied move (JSON "seq").
+    int16_t reserved[2]; ///< @brief Reserved channels (`sens5`, `sens6`), 0.
+} WsBinSensor;
+
+/**
+ * @struct sWsBinSensorAgg
+ * @brief Min/max/mean/RMS of the telemetry channels over the last broadcast window.
+ *
+ * Sent right after the @ref WsBinSensor with the same `seq`, only when some
+ * channel is selected. The header is followed by one @ref WsBinAggCh per bit
+ * set in `mask`, in channel order; values use the fixed-point scale of the
+ * channel in @ref WsBinSensor (0.01).
+ */
+typedef struct __attribute__((packed)) sWsBinSensorAgg
+{
+    WsBinHdr hdr;  ///< @brief Header, `op` = @ref WS_BIN_OP_SENSOR_AGG, `seq` of the sensor frame.
+    uint16_t n;    ///< @brief Number of samples in the window.
+    uint8_t mask;  ///< @brief Aggregated channels, bit i = `sens<i>`.
+    uint8_t count; ///< @brief Number of @ref WsBinAggCh that follow.
+} WsBinSensorAgg;
+
+/**
+ * @struct sWsBinAggCh
+ * @brief Aggregate of one channel in a @ref WsBinSensorAgg.
+ */
+typedef struct __attribute__((packed)) sWsBinAggCh
+{
+    int16_t min;  ///< @brief Minimum.
+    int16_t max;  ///< @brief Maximum.
+    int16_t mean; ///< @brief Mean.
+    int16_t rms;  ///< @brief Root mean square.
+} WsBinAggCh;
+
+/**
+ * @struct sWsBinSensorDelta
+ * @brief Telemetry frame with only the channels that moved past their deadband.
+ *
+ * The header is followed by one 16-bit value per bit set in `mask`, in
+ * channel order, with the scale of @ref WsBinSensor (the battery is
+ * unsigned). Shares the frame counter with @ref WsBinSensor, which is still
+ * sent as periodic keyframe. Also used for out-of-period alarm sends.
+ */
+typedef struct __attribute__((packed)) sWsBinSensorDelta
+{
+    WsBinHdr hdr;  ///< @brief Header, `op` = @ref WS_BIN_OP_SENSOR_DELTA, `seq` = frame counter.
+    uint32_t ms;   ///< @brief ESP32 `millis()` of the frame (`sens7`).
+    uint8_t mask;  ///< @brief Channels that follow, bit i = `sens<i>` (0..4).
+    uint8_t alarm; ///< @brief Active alarms, see @ref WsSensorAlarm.
+    uint16_t aseq; ///< @brief Sequence number of the last applied move (JSON "seq").
+} WsBinSensorDelta;
+
+/**
+ * @struct sWsBinAttitude
+ * @brief Attitude quaternion, for the 3D viewer.
+ *
+ * Published on the "attitude" topic at the "attHz" rate. The timestamp is
+ * the one of the IMU sample, so the client can interpolate at the real
+ * sampling instants regardless of the network jitter.
+ */
+typedef struct __attribute__((packed)) sWsBinAttitude
+{
+    WsBinHdr hdr;   ///< @brief Header, `op` = @ref WS_BIN_OP_ATTITUDE, `seq` = frame counter.
+    uint32_t tUs;   ///< @brief `esp_timer_get_time()` of the IMU sample, low 32 bits.
+    int16_t q[4];   ///< @brief Quaternion w, x, y, z, Q14 (16384 = 1.0).
+} WsBinAttitude;
+
+/**
+ * @struct sWsBinHistRec
+ * @brief One telemetry sample of the history ring, scales of @ref WsBinSensor.
+ */
+typedef struct __attribute__((packed)) sWsBinHistRec
+{
+    uint32_t ms;       ///< @brief ESP32 `millis()` of the sample.
+    int16_t angle[3];  ///< @brief Pitch, roll, yaw, 0.01 deg.
+    int16_t temp;      ///< @brief IMU temperature, 0.01 C.
+    uint16_t battery;  ///< @brief Battery voltage, mV.
+} WsBinHistRec;
+
+/**
+ * @struct sWsBinSensorHist
+ * @brief Recent telemetry history, oldest sample first.
+ *
+ * Sent once to a client when it subscribes to "sensor" in binary format, so
+ * its charts start with the last seconds of data. The header is followed by
+ * `count` records of `recSize` bytes (@ref WsBinHistRec).
+ */
+typedef struct __attribute__((packed)) sWsBinSensorHist
+{
+    WsBinHdr hdr;     ///< @brief Header, `op` = @ref WS_BIN_OP_SENSOR_HIST, `seq` = 0.
+    uint32_t ms;      ///< @brief ESP32 `millis()` when the frame was built.
+    uint16_t count;   ///< @brief Number of records.
+    uint8_t recSize;  ///< @brief Size of a record, `sizeof(WsBinHistRec)`.
+    uint8_t reserved; ///< @brief 0.
+} WsBinSensorHist;
+
+/**
+ * @enum WsSensorAlarm
+ * @brief Alarm bits of the telemetry (JSON "alarm", @ref WsBinSensorDelta::alarm).
+ */
+enum WsSensorAlarm : uint8_t
+{
+    WS_ALARM_TILT = 0x01, ///< Pitch or roll beyond the "alrTilt" threshold.
+    WS_ALARM_BATT = 0x02, ///< Battery below the "alrBatt" threshold.
+};
+
+static_assert(sizeof(WsBinHdr) == 4, "WsBinHdr must be 4 bytes");
+static_assert(sizeof(WsBinMove) == 8, "WsBinMove must be 8 bytes");
+static_assert(sizeof(WsBinAck) == 6, "WsBinAck must be 6 bytes");
+static_assert(sizeof(WsBinCmd) == 6, "WsBinCmd must be 6 bytes");
+static_assert(sizeof(WsBinPing) == 12, "WsBinPing must be 12 bytes");
+static_assert(sizeof(WsBinPong) == 28, "WsBinPong must be 28 bytes");
+static_assert(sizeof(WsBinSync) == 28, "WsBinSync must be 28 bytes");
+static_assert(sizeof(WsBinSyncReply) == 44, "WsBinSyncReply must be 44 bytes");
+static_assert(sizeof(WsBinSensor) == 24, "WsBinSensor must be 24 bytes");
+static_assert(sizeof(WsBinSensorAgg) == 8, "WsBinSensorAgg must be 8 bytes");
+static_assert(sizeof(WsBinAggCh) == 8, "WsBinAggCh must be 8 bytes");
+static_assert(sizeof(WsBinSensorDelta) == 12, "WsBinSensorDelta must be 12 bytes");
+static_assert(sizeof(WsBinAttitude) == 16, "WsBinAttitude must be 16 bytes");
+static_assert(sizeof(WsBinHistRec) == 14, "WsBinHistRec must be 14 bytes");
+static_assert(sizeof(WsBinSensorHist) == 12, "WsBinSensorHist must be 12 bytes");
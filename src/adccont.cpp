@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2025 Orazio Franco <robora2025@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * @file adccont.cpp
+ * @brief Implementation of the continuous ADC sampling.
+ */
+#include "adccont.h"
+#include <atomic>
+
+/// @brief Pins converted by the continuous driver.
+static const uint8_t adcPins[] = ADC_CONT_PINS;
+/// @brief Number of converted pins.
+static constexpr size_t adcPinCount = sizeof(adcPins) / sizeof(adcPins[0]);
+
+/// @brief Filtered pin voltages in mV, written by the ADC task only.
+static std::atomic<uint32_t> adcMv[adcPinCount];
+/// @brief Handle of the ADC task, notified by the end-of-frame callback.
+static TaskHandle_t adcTaskHandle = nullptr;
+
+/**
+ * @brief End-of-frame callback of the continuous driver (ISR context).
+ */
+static void ARDUINO_ISR_ATTR adcOnFrame()
+{
+  BaseType_t woken = pdFALSE;
+  if (adcTaskHandle)
+    vTaskNotifyGiveFromISR(adcTaskHandle, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief ADC task: collects the frames and runs the moving average.
+ *
+ * The window is a ring of the last @ref ADC_CONT_AVG_LEN frame averages per
+ * pin and a running sum, so each frame costs one subtraction and one addition.
+ * @param arg Unused.
+ */
+static void adcTask(void *arg)
+{
+  static uint16_t win[adcPinCount][ADC_CONT_AVG_LEN];
+  static uint32_t sum[adcPinCount];
+  uint8_t idx = 0;
+  uint8_t fill = 0;
+  for (;;)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    adc_continuous_data_t *res = nullptr;
+    if (!analogContinuousRead(&res, 0) || !res)
+      continue;
+    for (size_t i = 0; i < adcPinCount; i++)
+    {
+      uint16_t mv = (uint16_t)res[i].avg_read_mvolts;
+      sum[i] += mv - win[i][idx];
+      win[i][idx] = mv;
+    }
+    idx = (idx + 1) % ADC_CONT_AVG_LEN;
+    if (fill < ADC_CONT_AVG_LEN)
+      fill++;
+    for (size_t i = 0; i < adcPinCount; i++)
+      adcMv[i].store(sum[i] / fill, std::memory_order_relaxed);
+  }
+}
+
+/**
+ * @brief Starts the continuous sampling.
+ *
+ * The ADC task is created once, after the driver has started; if the driver
+ * fails it is released, so a later call (telemetry reload) retries cleanly.
+ * @return true if the sampling is running.
+ */
+bool adcContInit()
+{
+  static bool started = false;
+  if (started)
+    return true;
+  analogContinuousSetWidth(12);
+  analogContinuousSetAtten(ADC_11db);
+  bool configured = analogContinuous(adcPins, adcPinCount, ADC_CONT_CONV_PER_PIN, ADC_CONT_FREQ_HZ, &adcOnFrame);
+  started = configured && analogContinuousStart();
+  if (!started && configured)
+    analogContinuousDeinit();
+  if (started && !adcTaskHandle)
+    xTaskCreate(adcTask, "adc", ADC_CONT_TASK_STACK, nullptr, ADC_CONT_TASK_PRIO, &adcTaskHandle);
+  DEBUG_PRINTF("ADC continuous : %s\n", started ? "OK" : "KO");
+  return started;
+}
+
+/**
+ * @brief Gets the filtered voltage at an ADC pin.
+ *
+ * @param ch The channel (index in @ref ADC_CONT_PINS).
+ * @return The calibrated voltage at the pin in millivolts, 0 before the first frame.
+ */
+uint32_t adcContGetMv(uint8_t ch)
+{
+  return (ch < adcPinCount) ? adcMv[ch].load(std::memory_order_relaxed) : 0;
+}
+
+/**
+ * @brief Gets the battery voltage.
+ *
+ * @return The battery voltage in volts.
+ */
+float adcContGetBattery()
+{
+  return adcContGetMv(ADC_CH_BATTERY) * (VOLTAGE_DIVIDER_RATIO / 1000.0f);
+}
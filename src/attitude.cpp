@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2025 Orazio Franco <robora2025@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * @file attitude.cpp
+ * @brief Attitude filter fed by the IMU FIFO batches.
+ */
+#include "attitude.h"
+
+/// @brief Selected filter and its state.
+static Fusion fusion;
+/// @brief Current estimate.
+static Attitude att;
+
+/// @brief Spinlock protecting the statistics below.
+static portMUX_TYPE attStatsMux = portMUX_INITIALIZER_UNLOCKED;
+/// @brief Cost statistics (the mean is computed from @ref attCyclesSum).
+static AttitudeStats attStats;
+/// @brief Sum of the cycles per update, for the mean.
+static uint64_t attCyclesSum = 0;
+
+/**
+ * @brief Selects the filter and resets it.
+ *
+ * @param filter The filter ("filter" parameter).
+ * @param odrHz The FIFO sample rate.
+ */
+void attitudeReset(FusionFilter filter, uint16_t odrHz)
+{
+  FusionParams p;
+  p.odrHz = odrHz;
+  p.accLsbG = IMU_FIFO_ACC_LSB_G;
+  p.gyrLsbDps = IMU_FIFO_GYR_LSB_DPS;
+  p.complK = ATTITUDE_COMPL_K;
+  p.kp = ATTITUDE_KP;
+  p.ki = ATTITUDE_KI;
+  p.beta = ATTITUDE_BETA;
+  fusionInit(&fusion, filter < FUSION_COUNT ? filter : FUSION_COMPL_F, p);
+  att = Attitude();
+
+  portENTER_CRITICAL(&attStatsMux);
+  attStats = AttitudeStats();
+  attStats.filter = fusion.filter;
+  attCyclesSum = 0;
+  portEXIT_CRITICAL(&attStatsMux);
+}
+
+/**
+ * @brief Feeds one FIFO sample to the filter.
+ *
+ * @param s The sample.
+ */
+void attitudeUpdate(const ImuRaw &s)
+{
+  uint32_t c0 = ESP.getCycleCount();
+  fusionUpdate(&fusion, s.acc, s.gyr);
+  int32_t e[3];
+  fusionEuler(&fusion, e);
+  fusionQuat(&fusion, att.q);
+  uint32_t cycles = ESP.getCycleCount() - c0;
+
+  // Q16 -> gradi
+  att.pitch = e[0] * (1.0f / (1 << FX_DEG_SHIFT));
+  att.roll = e[1] * (1.0f / (1 << FX_DEG_SHIFT));
+  att.yaw = e[2] * (1.0f / (1 << FX_DEG_SHIFT));
+
+  portENTER_CRITICAL(&attStatsMux);
+  attStats.updates++;
+  attCyclesSum += cycles;
+  if (cycles > attStats.cyclesMax)
+    attStats.cyclesMax = cycles;
+  portEXIT_CRITICAL(&attStatsMux);
+}
+
+/**
+ * @brief Gets the current estimate.
+ *
+ * @return The attitude.
+ */
+Attitude attitudeGet() { return att; }
+
+/**
+ * @brief Gets the cost of the filter.
+ *
+ * @return A copy of the statistics.
+ */
+AttitudeStats attitudeGetStats()
+{
+  portENTER_CRITICAL(&attStatsMux);
+  AttitudeStats st = attStats;
+  st.cyclesAvg = st.updates ? (uint32_t)(attCyclesSum / st.updates) : 0;
+  portEXIT_CRITICAL(&attStatsMux);
+  return st;
+}
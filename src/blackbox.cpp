@@ -0,0 +1,336 @@
+/*
+ * Copyright (c) 2025 Orazio Franco <robora2025@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "blackbox.h"
+#include <atomic>
+#include "config.h"
+#include "motors.h"
+#include "adccont.h"
+#include "spscring.h"
+
+#ifdef CONFIG_PARTITION_USE_SPIFFS
+#define BB_FS SPIFFS
+#else
+#define BB_FS LittleFS
+#endif
+
+/// @brief Largest compressed record: the mask and a 5-byte varint per field.
+static constexpr size_t BB_REC_MAX = 2 + 5 * BB_F_COUNT;
+
+/**
+ * @enum BbCmd
+ * @brief Requests to the writer task.
+ */
+enum BbCmd : uint8_t
+{
+  BB_CMD_NONE = 0,
+  BB_CMD_START,
+  BB_CMD_STOP,
+};
+
+/// @brief Samples queued by the loop task for the writer task.
+static SpscRing<BlackboxSample, BLACKBOX_RING_SIZE> bbRing;
+/// @brief Handle of the writer task.
+static TaskHandle_t bbTaskHandle = nullptr;
+/// @brief Set by the writer task while the file is open; read by the producer.
+static std::atomic<bool> bbRecording{false};
+/// @brief Pending request (@ref BbCmd).
+static std::atomic<uint8_t> bbCmd{BB_CMD_NONE};
+/// @brief File size requested by the last `blackboxStart()`, KB.
+static std::atomic<uint16_t> bbCmdKb{0};
+
+/// @brief Status published by the writer task.
+static BlackboxStatus bbStatus;
+/// @brief Spinlock protecting @ref bbStatus.
+static portMUX_TYPE bbStatusMux = portMUX_INITIALIZER_UNLOCKED;
+
+/*-- Writer task state --*/
+static File bbFile;                      ///< @brief The open log file.
+static uint8_t *bbBlock = nullptr;       ///< @brief Block being filled (heap, @ref BLACKBOX_BLOCK_SIZE).
+static size_t bbUsed = 0;                ///< @brief Bytes of records in @ref bbBlock.
+static uint16_t bbCount = 0;             ///< @brief Records in @ref bbBlock.
+static uint16_t bbIndex = 0;             ///< @brief Number of the block being filled.
+static int32_t bbPrev[BB_F_COUNT];       ///< @brief Previous record of the block, the base of the deltas.
+
+/**
+ * @brief Appends an unsigned LEB128 varint.
+ * @param p Destination.
+ * @param v The value.
+ * @return The position after the varint.
+ */
+static uint8_t *bbPutVarint(uint8_t *p, uint32_t v)
+{
+  while (v >= 0x80)
+  {
+    *p++ = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  *p++ = (uint8_t)v;
+  return p;
+}
+
+/**
+ * @brief Compresses a sample at the end of the current block.
+ *
+ * The caller makes sure that @ref BB_REC_MAX bytes are free.
+ * @param s The sample.
+ */
+static void bbEncode(const BlackboxSample &s)
+{
+  const int32_t v[BB_F_COUNT] = {(int32_t)s.tUs, s.angle[0], s.angle[1], s.angle[2], s.temp,
+                                 s.q[0], s.q[1], s.q[2], s.q[3], s.targetA, s.targetB,
+                                 s.throttle, s.steer, s.battery};
+  uint8_t *rec = bbBlock + sizeof(BlackboxBlockHdr) + bbUsed;
+  uint8_t *p = rec + 2;
+  uint16_t mask = 0;
+  for (uint8_t i = 0; i < BB_F_COUNT; i++)
+  {
+    // differenza modulo 2^32 (il tempo si riavvolge), zigzag per i valori negativi
+    int32_t d = (int32_t)((uint32_t)v[i] - (uint32_t)bbPrev[i]);
+    if (d == 0 && i != BB_F_TIME)
+      continue;
+    mask |= 1u << i;
+    p = bbPutVarint(p, ((uint32_t)d << 1) ^ (uint32_t)(d >> 31));
+    bbPrev[i] = v[i];
+  }
+  rec[0] = (uint8_t)mask;
+  rec[1] = (uint8_t)(mask >> 8);
+  bbUsed += p - rec;
+  bbCount++;
+}
+
+/**
+ * @brief Writes the current block to the file and starts a new one.
+ *
+ * @return false if the file is full or the write failed.
+ */
+static bool bbFlushBlock()
+{
+  BlackboxBlockHdr h;
+  h.magic = BLACKBOX_MAGIC;
+  h.index = bbIndex;
+  h.count = bbCount;
+  h.used = (uint16_t)bbUsed;
+  h.fields = BB_F_COUNT;
+  h.ver = 1;
+  memcpy(bbBlock, &h, sizeof(h));
+  memset(bbBlock + sizeof(h) + bbUsed, 0, BLACKBOX_BLOCK_SIZE - sizeof(h) - bbUsed);
+  // un solo append di un blocco intero: il file resta allineato ai blocchi
+  bool ok = bbFile.write(bbBlock, BLACKBOX_BLOCK_SIZE) == BLACKBOX_BLOCK_SIZE;
+  if (ok)
+    bbFile.flush();
+  portENTER_CRITICAL(&bbStatusMux);
+  if (ok)
+  {
+    bbStatus.bytes += BLACKBOX_BLOCK_SIZE;
+    bbStatus.records += bbCount;
+  }
+  bool room = bbStatus.bytes + BLACKBOX_BLOCK_SIZE <= bbStatus.capacity;
+  bbStatus.full = ok && !room;
+  portEXIT_CRITICAL(&bbStatusMux);
+  bbIndex++;
+  bbUsed = 0;
+  bbCount = 0;
+  memset(bbPrev, 0, sizeof(bbPrev)); // ogni blocco riparte da un record completo
+  if (!ok)
+    DEBUG_PRINTLN("Blackbox: write failed");
+  return ok && room;
+}
+
+/**
+ * @brief Closes the recording.
+ *
+ * @param flush true to write the pending samples and the partial block,
+ *              false when the file is already full.
+ */
+static void bbClose(bool flush)
+{
+  bbRecording.store(false, std::memory_order_release);
+  BlackboxSample s;
+  bool room = flush;
+  while (room && bbRing.pop(s))
+  {
+    if (sizeof(BlackboxBlockHdr) + bbUsed + BB_REC_MAX > BLACKBOX_BLOCK_SIZE)
+      room = bbFlushBlock();
+    if (room)
+      bbEncode(s);
+  }
+  if (room && bbCount)
+    bbFlushBlock();
+  bbFile.close();
+  free(bbBlock);
+  bbBlock = nullptr;
+  portENTER_CRITICAL(&bbStatusMux);
+  bbStatus.recording = false;
+  portEXIT_CRITICAL(&bbStatusMux);
+  DEBUG_PRINTF("Blackbox: stop, %lu bytes\n", (unsigned long)bbStatus.bytes);
+}
+
+/**
+ * @brief Opens a new recording.
+ *
+ * The size of the file is reserved up front: it is limited to the free space
+ * of the partition (less @ref BLACKBOX_FS_MARGIN) and the recording stops when
+ * it is reached, so the log can never fill the filesystem.
+ * @param kb Requested size in KB.
+ */
+static void bbOpen(uint16_t kb)
+{
+  BB_FS.remove(BLACKBOX_FILE);
+  size_t freeBytes = BB_FS.totalBytes() - BB_FS.usedBytes();
+  size_t cap = (size_t)kb * 1024;
+  if (cap + BLACKBOX_FS_MARGIN > freeBytes)
+    cap = freeBytes > BLACKBOX_FS_MARGIN ? freeBytes - BLACKBOX_FS_MARGIN : 0;
+  cap -= cap % BLACKBOX_BLOCK_SIZE;
+  if (cap)
+    bbBlock = (uint8_t *)malloc(BLACKBOX_BLOCK_SIZE);
+  if (bbBlock)
+    bbFile = BB_FS.open(BLACKBOX_FILE, FILE_WRITE);
+  bool ok = bbBlock && bbFile;
+  if (!ok)
+  {
+    free(bbBlock);
+    bbBlock = nullptr;
+    DEBUG_PRINTF("Blackbox: cannot open %s (%u KB free)\n", BLACKBOX_FILE, (unsigned)(freeBytes / 1024));
+  }
+  bbUsed = 0;
+  bbCount = 0;
+  bbIndex = 0;
+  memset(bbPrev, 0, sizeof(bbPrev));
+  bbRing.clear();
+  portENTER_CRITICAL(&bbStatusMux);
+  bbStatus = BlackboxStatus();
+  bbStatus.recording = ok;
+  bbStatus.capacity = ok ? cap : 0;
+  portEXIT_CRITICAL(&bbStatusMux);
+  bbRecording.store(ok, std::memory_order_release);
+  DEBUG_PRINTF("Blackbox: start %s, %u KB\n", ok ? "OK" : "KO", (unsigned)(cap / 1024));
+}
+
+/**
+ * @brief Writer task: handles start/stop and compresses the queued samples.
+ *
+ * Wakes up every @ref BLACKBOX_FLUSH_MS (or when a request arrives) and
+ * drains the ring; flash is only written when a block is complete.
+ * @param arg Unused.
+ */
+static void bbTask(void *arg)
+{
+  for (;;)
+  {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(BLACKBOX_FLUSH_MS));
+    uint8_t cmd = bbCmd.exchange(BB_CMD_NONE);
+    if (cmd != BB_CMD_NONE && bbBlock)
+      bbClose(true);
+    if (cmd == BB_CMD_START)
+      bbOpen(bbCmdKb.load());
+    if (!bbBlock)
+      continue;
+    BlackboxSample s;
+    while (bbRing.pop(s))
+    {
+      if (sizeof(BlackboxBlockHdr) + bbUsed + BB_REC_MAX > BLACKBOX_BLOCK_SIZE && !bbFlushBlock())
+      {
+        bbClose(false); // file pieno
+        break;
+      }
+      bbEncode(s);
+    }
+  }
+}
+
+/**
+ * @brief Sends a request to the writer task, creating it the first time.
+ * @param cmd The request.
+ */
+static void bbRequest(BbCmd cmd)
+{
+  if (!bbTaskHandle)
+    xTaskCreate(bbTask, "blackbox", BLACKBOX_TASK_STACK, nullptr, BLACKBOX_TASK_PRIO, &bbTaskHandle);
+  bbCmd.store(cmd);
+  if (bbTaskHandle)
+    xTaskNotifyGive(bbTaskHandle);
+}
+
+/**
+ * @brief Starts a new recording, replacing the previous file.
+ *
+ * @param kb Size reserved for the file in KB.
+ * @return false if @p kb is 0.
+ */
+bool blackboxStart(uint16_t kb)
+{
+  if (!kb)
+    return false;
+  bbCmdKb.store(kb);
+  bbRequest(BB_CMD_START);
+  return true;
+}
+
+/**
+ * @brief Stops the recording.
+ */
+void blackboxStop()
+{
+  if (bbTaskHandle)
+    bbRequest(BB_CMD_STOP);
+}
+
+/**
+ * @brief Tells if samples are being recorded.
+ *
+ * @return true while a recording is running.
+ */
+bool blackboxRecording()
+{
+  return bbRecording.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief Queues one sample (producer side, loop task only).
+ *
+ * @param s The sample with the IMU fields set.
+ */
+void blackboxLog(BlackboxSample &s)
+{
+  if (!blackboxRecording())
+    return;
+  s.targetA = (int32_t)motorsGetLastTargetA();
+  s.targetB = (int32_t)motorsGetLastTargetB();
+  s.throttle = motorsGetThrottle();
+  s.steer = motorsGetSteer();
+  s.battery = (uint16_t)(adcContGetMv(ADC_CH_BATTERY) * VOLTAGE_DIVIDER_RATIO);
+  bbRing.push(s);
+}
+
+/**
+ * @brief Gets the state of the flight recorder.
+ *
+ * @return A copy of the state.
+ */
+BlackboxStatus blackboxGetStatus()
+{
+  portENTER_CRITICAL(&bbStatusMux);
+  BlackboxStatus st = bbStatus;
+  portEXIT_CRITICAL(&bbStatusMux);
+  st.dropped = bbRing.drops();
+  return st;
+}
@@ -38,6 +38,18 @@ WiFiCfg wifiCFG;
 /// \brief Runtime state: telemetry configuration.
 TeleCfg teleCFG;
 
+/**
+ * @brief Change callback registered for a namespace.
+ */
+typedef struct sConfigListener
+{
+    const char *pref_ns = nullptr; ///< @brief Namespace (nullptr = free slot).
+    ConfigChangeCb cb = nullptr;   ///< @brief Callback.
+} ConfigListener;
+
+/// \brief Change callbacks, see @ref configOnChange().
+static ConfigListener configListeners[CONFIG_MAX_LISTENERS];
+
 /**
  * @brief List of motor parameter metadata.
  */
@@ -52,6 +64,14 @@ const ParamInfo motorsParamsList[] = {
     {"invertB", "Inverti Motor B", PARAM_TYPE_BOOL, 0, 1, 0, {PARAM_TYPE_BOOL, {.int_val = MOTO_DEFAULT_INVERTB}}},
     {"tankInvThr", "Tank inverti Throttle", PARAM_TYPE_BOOL, 0, 1, 0, {PARAM_TYPE_BOOL, {.int_val = MOTO_DEFAULT_TANKINVTHR}}},
     {"tankInvStr", "Tank inverti Steer", PARAM_TYPE_BOOL, 0, 1, 0, {PARAM_TYPE_BOOL, {.int_val = MOTO_DEFAULT_TANKINVSTR}}},
+    {"ctrlHz", "Frequenza controllo motori (Hz)", PARAM_TYPE_INT, 50, 1000, 0, {PARAM_TYPE_INT, {.int_val = MOTO_DEFAULT_CTRLHZ}}},
+    {"accel", "Accelerazione (unità/s, 0=off)", PARAM_TYPE_INT, 0, 5000, 0, {PARAM_TYPE_INT, {.int_val = MOTO_DEFAULT_ACCEL}}},
+    {"decel", "Decelerazione (unità/s, 0=off)", PARAM_TYPE_INT, 0, 5000, 0, {PARAM_TYPE_INT, {.int_val = MOTO_DEFAULT_DECEL}}},
+    {"interp", "Interpola i setpoint", PARAM_TYPE_BOOL, 0, 1, 0, {PARAM_TYPE_BOOL, {.int_val = MOTO_DEFAULT_INTERP}}},
+    {"deadline", "Timeout move (ms, 0=off)", PARAM_TYPE_INT, 0, 5000, 0, {PARAM_TYPE_INT, {.int_val = MOTO_DEFAULT_DEADLINE}}},
+    {"brake", "Stop timeout in frenata (0=folle)", PARAM_TYPE_BOOL, 0, 1, 0, {PARAM_TYPE_BOOL, {.int_val = MOTO_DEFAULT_BRAKE}}},
+    {"lutMix", "Curve a tabella (LUT intera)", PARAM_TYPE_BOOL, 0, 1, 0, {PARAM_TYPE_BOOL, {.int_val = MOTO_DEFAULT_LUTMIX}}},
+    {"curve", "Punti curva x:y,... (vuoto=expo)", PARAM_TYPE_STRING, 0, 0, CONFIG_STRING_LEN, {PARAM_TYPE_STRING, {.str_val = MOTO_DEFAULT_CURVE}}},
 };
 
 /**
@@ -75,6 +95,20 @@ const ParamInfo wifiParamsList[] = {
 const ParamInfo telemetryParamsList[] = {
     {"enable", "Enable", PARAM_TYPE_BOOL, 0, 1, 0, {PARAM_TYPE_BOOL, {.int_val = TELE_DEFAULT_ENABLE}}},
     {"refresh", "Refersh Time", PARAM_TYPE_INT, 0, 3600, 0, {PARAM_TYPE_INT, {.int_val = TELE_DEFAULT_REFRESH}}},
+    {"fifo", "IMU FIFO", PARAM_TYPE_BOOL, 0, 1, 0, {PARAM_TYPE_BOOL, {.int_val = TELE_DEFAULT_FIFO}}},
+    {"odr", "IMU ODR FIFO (Hz)", PARAM_TYPE_INT, 25, 400, 0, {PARAM_TYPE_INT, {.int_val = TELE_DEFAULT_ODR}}},
+    {"aggMask", "Aggregati min/max/media/RMS (bit sens0..3)", PARAM_TYPE_INT, 0, 15, 0, {PARAM_TYPE_INT, {.int_val = TELE_DEFAULT_AGGMASK}}},
+    {"delta", "Invio solo variazioni (deadband)", PARAM_TYPE_BOOL, 0, 1, 0, {PARAM_TYPE_BOOL, {.int_val = TELE_DEFAULT_DELTA}}},
+    {"keyMs", "Keyframe (ms)", PARAM_TYPE_INT, 250, 60000, 0, {PARAM_TYPE_INT, {.int_val = TELE_DEFAULT_KEYMS}}},
+    {"dbAngle", "Deadband angoli (0.01 gradi)", PARAM_TYPE_INT, 0, 1000, 0, {PARAM_TYPE_INT, {.int_val = TELE_DEFAULT_DBANGLE}}},
+    {"dbTemp", "Deadband temperatura (0.01 C)", PARAM_TYPE_INT, 0, 1000, 0, {PARAM_TYPE_INT, {.int_val = TELE_DEFAULT_DBTEMP}}},
+    {"dbBatt", "Deadband batteria (mV)", PARAM_TYPE_INT, 0, 1000, 0, {PARAM_TYPE_INT, {.int_val = TELE_DEFAULT_DBBATT}}},
+    {"alrTilt", "Allarme inclinazione (gradi, 0=off)", PARAM_TYPE_INT, 0, 90, 0, {PARAM_TYPE_INT, {.int_val = TELE_DEFAULT_ALRTILT}}},
+    {"alrBatt", "Allarme batteria (mV, 0=off)", PARAM_TYPE_INT, 0, 20000, 0, {PARAM_TYPE_INT, {.int_val = TELE_DEFAULT_ALRBATT}}},
+    {"filter", "Filtro assetto FIFO (0=compl. float,1=compl. Q,2=Mahony,3=Madgwick)", PARAM_TYPE_INT, 0, 3, 0, {PARAM_TYPE_INT, {.int_val = TELE_DEFAULT_FILTER}}},
+    {"attHz", "Quaternione 3D (Hz, 0=off)", PARAM_TYPE_INT, 0, 100, 0, {PARAM_TYPE_INT, {.int_val = TELE_DEFAULT_ATTHZ}}},
+    {"histKB", "Storico telemetria (KB, 0=off)", PARAM_TYPE_INT, 0, 16, 0, {PARAM_TYPE_INT, {.int_val = TELE_DEFAULT_HISTKB}}},
+    {"bbKB", "Scatola nera su flash (KB, 0=off)", PARAM_TYPE_INT, 0, 512, 0, {PARAM_TYPE_INT, {.int_val = TELE_DEFAULT_BBKB}}},
 };
 
 /// \brief Number of motor parameters.
@@ -102,6 +136,8 @@ void configAppendSection(String &jsonString, const char *sectionName, const Para
 void configReloadValue(const ParamInfo *paramInfo, const ConfigValue &value);
 /// Applica un valore espresso come stringa (da NVS o UI) alla struttura runtime.
 void configApplyCFG(const char *pref_ns, const String &key, const String &val);
+/// Notifica ai moduli registrati la modifica di un parametro.
+static void configNotifyChange(const char *pref_ns, const char *key);
 /** @} */
 
 /**
@@ -572,6 +608,7 @@ size_t configPut(const char *key, const String &value)
     {
         configApplyCFG(ptr_pref_ns, String(key), appliedStr);
         DEBUG_PRINTF("Config_wr: [%s] %s = %s (bytes=%u)\n", ptr_pref_ns, key, appliedStr.c_str(), (unsigned)written);
+        configNotifyChange(ptr_pref_ns, key);
     }
 
     return written;
@@ -607,6 +644,7 @@ bool configPutInt(const char *key, int value)
     prefs.end();
 
     configApplyCFG(ns, String(key), String(value));
+    configNotifyChange(ns, key);
     return true;
 }
 
@@ -651,6 +689,7 @@ bool configPutFloat(const char *key, float value)
     prefs.end();
 
     configApplyCFG(ns, String(key), String(value));
+    configNotifyChange(ns, key);
     return true;
 }
 
@@ -682,9 +721,45 @@ bool configPutText(const char *key, const String &value)
     prefs.end();
 
     configApplyCFG(ns, String(key), v);
+    configNotifyChange(ns, key);
     return true;
 }
 
+/**
+ * @brief Registers a change callback for the parameters of a namespace.
+ * @param pref_ns The namespace.
+ * @param cb The callback.
+ * @return True if registered (or already registered), false if the table is full.
+ */
+bool configOnChange(const char *pref_ns, ConfigChangeCb cb)
+{
+    for (ConfigListener &l : configListeners)
+    {
+        if (l.cb == cb && l.pref_ns && strcmp(l.pref_ns, pref_ns) == 0)
+            return true;
+        if (!l.cb)
+        {
+            l.pref_ns = pref_ns;
+            l.cb = cb;
+            return true;
+        }
+    }
+    DEBUG_PRINTF("Config: troppi listener, %s ignorato\n", pref_ns);
+    return false;
+}
+
+/**
+ * @brief Calls the change callbacks registered for the namespace of a parameter.
+ * @param pref_ns The namespace.
+ * @param key The parameter key.
+ */
+static void configNotifyChange(const char *pref_ns, const char *key)
+{
+    for (const ConfigListener &l : configListeners)
+        if (l.cb && strcmp(l.pref_ns, pref_ns) == 0)
+            l.cb(key);
+}
+
 /**
  * @brief Converts a parameter type to an HTML input type string (for UI).
  * @param type The parameter type.
@@ -796,6 +871,22 @@ void configReloadValue(const ParamInfo *paramInfo, const ConfigValue &value)
         motoCFG.tankInvThr = value.value.int_val;
     else if (strcmp(paramInfo->key, "tankInvStr") == 0)
         motoCFG.tankInvStr = value.value.int_val;
+    else if (strcmp(paramInfo->key, "ctrlHz") == 0)
+        motoCFG.ctrlHz = constrain(value.value.int_val, paramInfo->min_val, paramInfo->max_val);
+    else if (strcmp(paramInfo->key, "accel") == 0)
+        motoCFG.accel = constrain(value.value.int_val, paramInfo->min_val, paramInfo->max_val);
+    else if (strcmp(paramInfo->key, "decel") == 0)
+        motoCFG.decel = constrain(value.value.int_val, paramInfo->min_val, paramInfo->max_val);
+    else if (strcmp(paramInfo->key, "interp") == 0)
+        motoCFG.interp = value.value.int_val;
+    else if (strcmp(paramInfo->key, "deadline") == 0)
+        motoCFG.deadline = constrain(value.value.int_val, paramInfo->min_val, paramInfo->max_val);
+    else if (strcmp(paramInfo->key, "brake") == 0)
+        motoCFG.brake = value.value.int_val;
+    else if (strcmp(paramInfo->key, "lutMix") == 0)
+        motoCFG.lutMix = value.value.int_val;
+    else if (strcmp(paramInfo->key, "curve") == 0)
+        strncpy(motoCFG.curve, value.value.str_val, paramInfo->max_len - 1);
 
     else if (strcmp(paramInfo->key, "ap_sta") == 0)
         wifiCFG.ap_sta = value.value.int_val;
@@ -820,6 +911,34 @@ void configReloadValue(const ParamInfo *paramInfo, const ConfigValue &value)
         teleCFG.enable = value.value.int_val;
     else if (strcmp(paramInfo->key, "refresh") == 0)
         teleCFG.refresh = value.value.int_val;
+    else if (strcmp(paramInfo->key, "fifo") == 0)
+        teleCFG.fifo = value.value.int_val;
+    else if (strcmp(paramInfo->key, "odr") == 0)
+        teleCFG.odr = constrain(value.value.int_val, paramInfo->min_val, paramInfo->max_val);
+    else if (strcmp(paramInfo->key, "aggMask") == 0)
+        teleCFG.aggMask = constrain(value.value.int_val, paramInfo->min_val, paramInfo->max_val);
+    else if (strcmp(paramInfo->key, "delta") == 0)
+        teleCFG.delta = value.value.int_val;
+    else if (strcmp(paramInfo->key, "keyMs") == 0)
+        teleCFG.keyMs = constrain(value.value.int_val, paramInfo->min_val, paramInfo->max_val);
+    else if (strcmp(paramInfo->key, "dbAngle") == 0)
+        teleCFG.dbAngle = constrain(value.value.int_val, paramInfo->min_val, paramInfo->max_val);
+    else if (strcmp(paramInfo->key, "dbTemp") == 0)
+        teleCFG.dbTemp = constrain(value.value.int_val, paramInfo->min_val, paramInfo->max_val);
+    else if (strcmp(paramInfo->key, "dbBatt") == 0)
+        teleCFG.dbBatt = constrain(value.value.int_val, paramInfo->min_val, paramInfo->max_val);
+    else if (strcmp(paramInfo->key, "alrTilt") == 0)
+        teleCFG.alrTilt = constrain(value.value.int_val, paramInfo->min_val, paramInfo->max_val);
+    else if (strcmp(paramInfo->key, "alrBatt") == 0)
+        teleCFG.alrBatt = constrain(value.value.int_val, paramInfo->min_val, paramInfo->max_val);
+    else if (strcmp(paramInfo->key, "filter") == 0)
+        teleCFG.filter = constrain(value.value.int_val, paramInfo->min_val, paramInfo->max_val);
+    else if (strcmp(paramInfo->key, "attHz") == 0)
+        teleCFG.attHz = constrain(value.value.int_val, paramInfo->min_val, paramInfo->max_val);
+    else if (strcmp(paramInfo->key, "histKB") == 0)
+        teleCFG.histKB = constrain(value.value.int_val, paramInfo->min_val, paramInfo->max_val);
+    else if (strcmp(paramInfo->key, "bbKB") == 0)
+        teleCFG.bbKB = constrain(value.value.int_val, paramInfo->min_val, paramInfo->max_val);
 };
 
 /**
@@ -867,6 +986,8 @@ void configPrintConfig(void)
     DEBUG_PRINTF("maxVel: %d deadzone: %d expoPct: %d SteerGain: %d  \n", motoCFG.maxVel, motoCFG.deadzone, motoCFG.expoPct, motoCFG.SteerGain);
     DEBUG_PRINTF("arcadeK: %d arcadeEnabled: %d  \n", motoCFG.arcadeK, motoCFG.arcadeEnabled);
     DEBUG_PRINTF("invMotA: %d invMotA: %d tankInvThr: %d tankInvStr: %d \n", motoCFG.invertA, motoCFG.invertB, motoCFG.tankInvThr, motoCFG.tankInvStr);
+    DEBUG_PRINTF("ctrlHz: %d accel: %d decel: %d interp: %d \n", motoCFG.ctrlHz, motoCFG.accel, motoCFG.decel, motoCFG.interp);
+    DEBUG_PRINTF("deadline: %d brake: %d lutMix: %d curve: %s \n", motoCFG.deadline, motoCFG.brake, motoCFG.lutMix, motoCFG.curve);
     DEBUG_PRINTF("WIFI CFG: %d parametri \n", wifiParamsCount);
     DEBUG_PRINTF("Type - %s Retry:%d \n", wifiCFG.ap_sta ? "STA" : "AP", wifiCFG.retray);
     DEBUG_PRINTF("ST   - SSID: %s PASS:%s \n", wifiCFG.STssid, wifiCFG.STpass);
@@ -874,6 +995,10 @@ void configPrintConfig(void)
     DEBUG_PRINTF("       IP: %s GW:%s SU:%s \n", wifiCFG.AP__ip, wifiCFG.AP__gw, wifiCFG.AP_sub);
     DEBUG_PRINTF("TELE CFG: %d parametri \n", telemetryParamsCount);
     DEBUG_PRINTF("Enable - %s Retry:%d \n", teleCFG.enable ? "ON " : "OFF", teleCFG.refresh);
+    DEBUG_PRINTF("FIFO - %s ODR:%d FILTER:%d AGG:0x%X \n", teleCFG.fifo ? "ON " : "OFF", teleCFG.odr, teleCFG.filter, teleCFG.aggMask);
+    DEBUG_PRINTF("ATTITUDE - %u Hz HISTORY - %u KB BLACKBOX - %u KB \n", teleCFG.attHz, teleCFG.histKB, teleCFG.bbKB);
+    DEBUG_PRINTF("DELTA - %s KEY:%u DB:%u/%u/%u ALR:%u/%u \n", teleCFG.delta ? "ON " : "OFF", teleCFG.keyMs,
+                 teleCFG.dbAngle, teleCFG.dbTemp, teleCFG.dbBatt, teleCFG.alrTilt, teleCFG.alrBatt);
 }
 
 /**
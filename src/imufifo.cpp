@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2025 Orazio Franco <robora2025@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * @file imufifo.cpp
+ * @brief Implementation of the ICM42670 FIFO mode.
+ *
+ * Register map from the ICM-42670-P datasheet (user bank 0 and MREG1).
+ */
+#include "imufifo.h"
+
+/** @name ICM42670 registers
+ * @{ */
+#define ICM_SIGNAL_PATH_RESET 0x02
+#define ICM_PWR_MGMT0 0x1F
+#define ICM_GYRO_CONFIG0 0x20
+#define ICM_ACCEL_CONFIG0 0x21
+#define ICM_FIFO_CONFIG1 0x28
+#define ICM_INTF_CONFIG0 0x35
+#define ICM_FIFO_COUNTH 0x3D
+#define ICM_FIFO_DATA 0x3F
+#define ICM_BLK_SEL_W 0x79
+#define ICM_MADDR_W 0x7A
+#define ICM_M_W 0x7B
+#define ICM_MREG1_FIFO_CONFIG5 0x01
+/** @} */
+
+/** @name Register values
+ * @{ */
+#define ICM_FIFO_FLUSH 0x04        // SIGNAL_PATH_RESET: FIFO_FLUSH
+#define ICM_PWR_LN 0x0F            // PWR_MGMT0: gyro and accel in low-noise mode
+#define ICM_GYRO_FS_500 (2 << 5)   // GYRO_CONFIG0: +-500 dps
+#define ICM_ACCEL_FS_4G (2 << 5)   // ACCEL_CONFIG0: +-4 g
+#define ICM_INTF_COUNT_REC 0x70    // INTF_CONFIG0: FIFO count in records, big endian count and data
+#define ICM_FIFO_STREAM 0x00       // FIFO_CONFIG1: stream mode, no bypass
+#define ICM_FIFO_BYPASS 0x01       // FIFO_CONFIG1: bypass
+#define ICM_FIFO_ACC_GYR 0x03      // FIFO_CONFIG5: accel and gyro packets
+#define ICM_FIFO_PKT_SIZE 16       // header, accel, gyro, temp, timestamp
+#define ICM_FIFO_HDR_EMPTY 0x80    // header: FIFO empty
+#define ICM_FIFO_HDR_ACC_GYR 0x60  // header: packet carries accel and gyro
+/** @} */
+
+/**
+ * @brief Writes a register of user bank 0.
+ * @param reg The register.
+ * @param val The value.
+ * @return true on success.
+ */
+static bool icmWrite(uint8_t reg, uint8_t val)
+{
+  Wire.beginTransmission(IMU_I2C_ADDR);
+  Wire.write(reg);
+  Wire.write(val);
+  return Wire.endTransmission() == 0;
+}
+
+/**
+ * @brief Reads consecutive registers with a single transaction (repeated start).
+ * @param reg The first register.
+ * @param buf Destination buffer.
+ * @param len Number of bytes, at most @ref IMU_FIFO_BURST.
+ * @return true if all the bytes were read.
+ */
+static bool icmRead(uint8_t reg, uint8_t *buf, size_t len)
+{
+  Wire.beginTransmission(IMU_I2C_ADDR);
+  Wire.write(reg);
+  if (Wire.endTransmission(false) != 0)
+    return false;
+  if (Wire.requestFrom((uint8_t)IMU_I2C_ADDR, len) != len)
+    return false;
+  return Wire.readBytes(buf, len) == len;
+}
+
+/**
+ * @brief Writes a register of the MREG1 bank through BLK_SEL_W/MADDR_W/M_W.
+ * @param reg The MREG1 register.
+ * @param val The value.
+ * @return true on success.
+ */
+static bool icmWriteMreg1(uint8_t reg, uint8_t val)
+{
+  bool ok = icmWrite(ICM_BLK_SEL_W, 0x00) && icmWrite(ICM_MADDR_W, reg) && icmWrite(ICM_M_W, val);
+  delayMicroseconds(10); // tempo di accesso MREG richiesto dal datasheet
+  return ok;
+}
+
+/**
+ * @brief Converts an ODR in Hz into the ODR field of GYRO/ACCEL_CONFIG0.
+ * @param odrHz Requested ODR, rounded down to a supported one (25..400 Hz).
+ * @param code Receives the register code.
+ * @return The ODR in Hz matching @p code.
+ */
+static uint16_t icmOdrCode(uint16_t odrHz, uint8_t &code)
+{
+  static const struct
+  {
+    uint16_t hz;
+    uint8_t code;
+  } odr[] = {{400, 0x07}, {200, 0x08}, {100, 0x09}, {50, 0x0A}, {25, 0x0B}};
+  for (auto &o : odr)
+    if (odrHz >= o.hz)
+    {
+      code = o.code;
+      return o.hz;
+    }
+  code = 0x0B;
+  return 25;
+}
+
+/**
+ * @brief Enables the FIFO at the given output data rate.
+ *
+ * @param odrHz The requested output data rate in Hz.
+ * @return The ODR actually programmed in Hz, 0 if the IMU did not answer.
+ */
+uint16_t imuFifoBegin(uint16_t odrHz)
+{
+  uint8_t code;
+  uint16_t hz = icmOdrCode(odrHz, code);
+  bool ok = icmWrite(ICM_PWR_MGMT0, ICM_PWR_LN);
+  delayMicroseconds(200); // il PWR_MGMT0 non va riscritto prima di 200 us
+  ok = ok && icmWrite(ICM_GYRO_CONFIG0, ICM_GYRO_FS_500 | code);
+  ok = ok && icmWrite(ICM_ACCEL_CONFIG0, ICM_ACCEL_FS_4G | code);
+  ok = ok && icmWrite(ICM_INTF_CONFIG0, ICM_INTF_COUNT_REC);
+  ok = ok && icmWriteMreg1(ICM_MREG1_FIFO_CONFIG5, ICM_FIFO_ACC_GYR);
+  ok = ok && icmWrite(ICM_FIFO_CONFIG1, ICM_FIFO_STREAM);
+  ok = ok && icmWrite(ICM_SIGNAL_PATH_RESET, ICM_FIFO_FLUSH);
+  DEBUG_PRINTF("IMU FIFO %u Hz : %s\n", hz, ok ? "OK" : "KO");
+  return ok ? hz : 0;
+}
+
+/**
+ * @brief Disables the FIFO (bypass mode).
+ */
+void imuFifoEnd()
+{
+  icmWrite(ICM_FIFO_CONFIG1, ICM_FIFO_BYPASS);
+}
+
+/**
+ * @brief Reads a big-endian int16 from a packet.
+ * @param p Pointer to the two bytes.
+ * @return The value.
+ */
+static inline int16_t icmBe16(const uint8_t *p)
+{
+  return (int16_t)((p[0] << 8) | p[1]);
+}
+
+/**
+ * @brief Drains the FIFO.
+ *
+ * @param out Destination of the decoded samples.
+ * @param max Capacity of @p out.
+ * @return The number of samples written to @p out.
+ */
+size_t imuFifoRead(ImuRaw *out, size_t max)
+{
+  uint8_t cnt[2];
+  if (!icmRead(ICM_FIFO_COUNTH, cnt, sizeof(cnt)))
+    return 0;
+  size_t pending = (size_t)((cnt[0] << 8) | cnt[1]); // record, non byte (INTF_CONFIG0)
+  if (pending > max)
+    pending = max; // il resto resta in FIFO per la prossima lettura
+
+  static uint8_t burst[IMU_FIFO_BURST];
+  const size_t perBurst = IMU_FIFO_BURST / ICM_FIFO_PKT_SIZE;
+  size_t n = 0;
+  while (pending)
+  {
+    size_t pkts = pending < perBurst ? pending : perBurst;
+    if (!icmRead(ICM_FIFO_DATA, burst, pkts * ICM_FIFO_PKT_SIZE))
+      break;
+    pending -= pkts;
+    for (size_t i = 0; i < pkts; i++)
+    {
+      const uint8_t *p = burst + i * ICM_FIFO_PKT_SIZE;
+      if ((p[0] & ICM_FIFO_HDR_EMPTY) || (p[0] & ICM_FIFO_HDR_ACC_GYR) != ICM_FIFO_HDR_ACC_GYR)
+        continue;
+      ImuRaw &r = out[n];
+      for (uint8_t k = 0; k < 3; k++)
+      {
+        r.acc[k] = icmBe16(p + 1 + 2 * k);
+        r.gyr[k] = icmBe16(p + 7 + 2 * k);
+      }
+      if (r.acc[0] == INT16_MIN) // campione non valido (sensore in avvio)
+        continue;
+      r.temp = (int8_t)p[13];
+      r.ts = (uint16_t)((p[14] << 8) | p[15]);
+      n++;
+    }
+  }
+  return n;
+}
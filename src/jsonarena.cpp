@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2025 Orazio Franco <robora2025@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * @file jsonarena.cpp
+ * @brief Implementation of the ArduinoJson arena and counting heap allocators.
+ */
+#include "jsonarena.h"
+
+/// @brief Allocation counters.
+static JsonArenaStats stats;
+
+/**
+ * @struct ArenaHdr
+ * @brief Header in front of every arena block, keeps the 8-byte alignment.
+ */
+typedef struct alignas(8) sArenaHdr
+{
+    size_t size; ///< @brief Requested size of the block.
+} ArenaHdr;
+
+/**
+ * @brief Rounds a size up to the arena alignment.
+ * @param n The size.
+ * @return The aligned size.
+ */
+static inline size_t arenaAlign(size_t n)
+{
+    return (n + 7u) & ~(size_t)7u;
+}
+
+/**
+ * @brief Checks if a pointer was returned by this arena.
+ * @param ptr The pointer.
+ * @return true if it lies inside the buffer.
+ */
+bool JsonArena::owns(const void *ptr) const
+{
+    const uint8_t *p = (const uint8_t *)ptr;
+    return p >= base && p < base + cap;
+}
+
+/**
+ * @brief Allocates a block from the arena, or from the heap if it does not fit.
+ * @param size The number of bytes.
+ * @return Pointer to the block, nullptr if also the heap is exhausted.
+ */
+void *JsonArena::allocate(size_t size)
+{
+    size_t need = sizeof(ArenaHdr) + arenaAlign(size);
+    if (top + need > cap)
+    {
+        stats.heapAllocs++;
+        return malloc(size);
+    }
+    ArenaHdr *h = (ArenaHdr *)(base + top);
+    h->size = size;
+    last = top;
+    top += need;
+    if (top > stats.peak)
+        stats.peak = top;
+    stats.arenaAllocs++;
+    return h + 1;
+}
+
+/**
+ * @brief Releases a block: heap blocks are freed, the last arena block is given back.
+ * @param ptr The block.
+ */
+void JsonArena::deallocate(void *ptr)
+{
+    if (!ptr)
+        return;
+    if (!owns(ptr))
+    {
+        free(ptr);
+        return;
+    }
+    size_t off = (uint8_t *)ptr - base - sizeof(ArenaHdr);
+    if (off == last)
+    {
+        top = last;
+        last = SIZE_MAX;
+    }
+}
+
+/**
+ * @brief Resizes a block, in place if it is the last one of the arena.
+ * @param ptr The block (nullptr behaves as `allocate()`).
+ * @param new_size The new size in bytes.
+ * @return Pointer to the resized block, nullptr on failure.
+ */
+void *JsonArena::reallocate(void *ptr, size_t new_size)
+{
+    if (!ptr)
+        return allocate(new_size);
+    if (!owns(ptr))
+    {
+        stats.heapAllocs++;
+        return realloc(ptr, new_size);
+    }
+
+    ArenaHdr *h = (ArenaHdr *)ptr - 1;
+    size_t off = (uint8_t *)h - base;
+    if (new_size <= h->size)
+    {
+        h->size = new_size;
+        if (off == last)
+            top = off + sizeof(ArenaHdr) + arenaAlign(new_size);
+        return ptr;
+    }
+    if (off == last && off + sizeof(ArenaHdr) + arenaAlign(new_size) <= cap)
+    {
+        h->size = new_size;
+        top = off + sizeof(ArenaHdr) + arenaAlign(new_size);
+        if (top > stats.peak)
+            stats.peak = top;
+        return ptr;
+    }
+
+    size_t oldSize = h->size;
+    void *q = allocate(new_size);
+    if (q)
+        memcpy(q, ptr, oldSize);
+    return q; // the old block stays in the arena until reset()
+}
+
+/**
+ * @brief Releases all the blocks of the arena.
+ */
+void JsonArena::reset()
+{
+    top = 0;
+    last = SIZE_MAX;
+    stats.resets++;
+}
+
+/**
+ * @brief Allocates from the heap and counts it.
+ * @param size The number of bytes.
+ * @return Pointer to the block.
+ */
+void *JsonHeapAllocator::allocate(size_t size)
+{
+    stats.heapAllocs++;
+    return malloc(size);
+}
+
+/**
+ * @brief Frees a heap block.
+ * @param ptr The block.
+ */
+void JsonHeapAllocator::deallocate(void *ptr)
+{
+    free(ptr);
+}
+
+/**
+ * @brief Reallocates a heap block and counts it.
+ * @param ptr The block.
+ * @param new_size The new size in bytes.
+ * @return Pointer to the block.
+ */
+void *JsonHeapAllocator::reallocate(void *ptr, size_t new_size)
+{
+    stats.heapAllocs++;
+    return realloc(ptr, new_size);
+}
+
+/**
+ * @brief Shared instance of the counting heap allocator.
+ * @return Pointer to the instance.
+ */
+JsonHeapAllocator *JsonHeapAllocator::instance()
+{
+    static JsonHeapAllocator inst;
+    return &inst;
+}
+
+/**
+ * @brief Returns a copy of the allocation counters.
+ * @return The @ref JsonArenaStats.
+ */
+JsonArenaStats jsonArenaGetStats()
+{
+    return stats;
+}
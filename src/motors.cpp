@@ -55,11 +55,78 @@ RoBoRa_8833 motors(cfgA, cfgB);
 volatile int16_t joyX = 0, joyY = 0;
 
 /**
- * @brief Stores the timestamp of the last time motor commands were applied.
- *
- * Used to implement a a periodic update mechanism in `motorsTick()`.
+ * @struct MotorsSetpoint
+ * @brief Setpoint shared between the writers and the control task.
+ */
+typedef struct sMotorsSetpoint
+{
+  int16_t throttle = 0; ///< @brief Throttle.
+  int16_t steer = 0;    ///< @brief Steer.
+  uint16_t seq = 0;     ///< @brief Sequence number of the move command.
+  uint32_t postUs = 0;  ///< @brief Timestamp of `motorsPost()`, in microseconds.
+  bool posted = false;  ///< @brief The setpoint comes from a move command (`motorsPost()`).
+} MotorsSetpoint;
+
+/// @brief Setpoint double buffer, read by the control task without locks.
+static DoubleBuf<MotorsSetpoint> setpointBuf;
+/// @brief Serializes the writers of @ref setpointBuf (AsyncTCP task and main loop).
+static portMUX_TYPE setpointMux = portMUX_INITIALIZER_UNLOCKED;
+/// @brief Sequence number of the last setpoint applied from a move command.
+static volatile uint16_t appliedSeq = 0;
+/// @brief Timing of the last setpoint applied from a move command, protected by @ref ctrlStatsMux.
+static MotorsApplyStamp applyStamp;
+
+/// @brief Handle of the control task.
+static TaskHandle_t ctrlTaskHandle = nullptr;
+/// @brief Periodic timer that wakes up the control task.
+static esp_timer_handle_t ctrlTimer = nullptr;
+/// @brief Held by `motorsInit()` while the driver is (re)configured, the control task skips that period.
+static SemaphoreHandle_t ctrlLock = nullptr;
+/// @brief The driver is configured (`motors.begin()` succeeded).
+static bool ctrlReady = false;
+/// @brief Interpolation and slew limit between the setpoints and the outputs, owned by the control task.
+static MotorTraj ctrlTraj;
+/// @brief Set by `motorsInit()`: the control task restarts @ref ctrlTraj from zero.
+static bool ctrlTrajReset = true;
+/// @brief Slew limits and interpolation flag, copied from @ref MotoCfg under @ref ctrlLock.
+static uint16_t ctrlAccel = MOTO_DEFAULT_ACCEL, ctrlDecel = MOTO_DEFAULT_DECEL;
+static bool ctrlInterp = MOTO_DEFAULT_INTERP;
+/// @brief Move deadline (0 = watchdog off) and stop mode, copied from @ref MotoCfg under @ref ctrlLock.
+static uint32_t ctrlDeadlineUs = MOTO_DEFAULT_DEADLINE * 1000UL;
+static bool ctrlBrake = MOTO_DEFAULT_BRAKE;
+
+/**
+ * @struct MotorsWatchdog
+ * @brief State of the move deadline watchdog, owned by the control task.
  */
-static uint32_t lastMoveApplyMs = 0;
+typedef struct sMotorsWatchdog
+{
+  uint32_t moveUs = 0;   ///< @brief Post time of the last move setpoint (0 = none yet, watchdog not armed).
+  bool tripped = false;  ///< @brief The deadline passed: the setpoint is zero until the next move.
+  bool stopping = false; ///< @brief Ramping down, the stop mode is applied when the output reaches zero.
+  uint32_t tripUs = 0;   ///< @brief When the deadline passed.
+} MotorsWatchdog;
+
+/// @brief The move deadline watchdog.
+static MotorsWatchdog ctrlWd;
+
+/// @brief Shaping tables, rebuilt by `motorsInit()` under @ref ctrlLock.
+static MixLut ctrlLut;
+/// @brief @ref ctrlLut shapes the output (`lutMix`), the driver shaping is neutral.
+static bool ctrlLutOn = false;
+
+/// @brief Spinlock protecting the statistics below and @ref applyStamp.
+static portMUX_TYPE ctrlStatsMux = portMUX_INITIALIZER_UNLOCKED;
+/// @brief Timing statistics (jitter percentiles are computed from @ref ctrlJitter).
+static MotorsCtrlStats ctrlStats;
+/// @brief Rolling histogram of the control period jitter.
+static LatHist ctrlJitter;
+/// @brief Sum of the jitter, for the mean.
+static uint64_t ctrlJitterSum = 0;
+/// @brief Timestamp of the previous period (0 = none since the last start).
+static uint32_t ctrlLastUs = 0;
+/// @brief Nominal period of the control task.
+static uint32_t ctrlPeriodUs = 1000000UL / MOTO_DEFAULT_CTRLHZ;
 
 /**
  * @brief Indicates the motors re-initialization.
@@ -68,30 +135,369 @@ static uint32_t lastMoveApplyMs = 0;
  */
 bool motorsReinit = false;
 
+/**
+ * @brief Timer callback: wakes up the control task.
+ *
+ * Runs in the esp_timer task, so it only sends a notification.
+ * @param arg Unused.
+ */
+static void motorsTimerCb(void *arg)
+{
+  if (ctrlTaskHandle)
+    xTaskNotifyGive(ctrlTaskHandle);
+}
+
+/**
+ * @brief Updates the timing statistics with a new control period.
+ *
+ * @param tUs Wake-up time of the period.
+ * @param busyUs Time spent in the period.
+ */
+static void motorsStatsAdd(uint32_t tUs, uint32_t busyUs)
+{
+  portENTER_CRITICAL(&ctrlStatsMux);
+  ctrlStats.ticks++;
+  if (busyUs > ctrlStats.busyMaxUs)
+    ctrlStats.busyMaxUs = busyUs;
+  if (ctrlLastUs)
+  {
+    uint32_t period = tUs - ctrlLastUs;
+    uint32_t jitter = (period > ctrlPeriodUs) ? period - ctrlPeriodUs : ctrlPeriodUs - period;
+    if (ctrlStats.periodMinUs == 0 || period < ctrlStats.periodMinUs)
+      ctrlStats.periodMinUs = period;
+    if (period > ctrlStats.periodMaxUs)
+      ctrlStats.periodMaxUs = period;
+    if (jitter > ctrlStats.jitterMaxUs)
+      ctrlStats.jitterMaxUs = jitter;
+    ctrlJitterSum += jitter;
+    latHistAdd(&ctrlJitter, jitter);
+  }
+  ctrlLastUs = tUs;
+  portEXIT_CRITICAL(&ctrlStatsMux);
+}
+
+/**
+ * @brief Counts a period skipped because the control lock was busy.
+ *
+ * The wake-up time still becomes the reference of the next period, so a
+ * re-init does not show up as a scheduling overrun in the jitter. The next
+ * trajectory step then covers one period less: the ramp is slower, never faster.
+ * @param tUs Wake-up time of the period.
+ */
+static void motorsStatsSkip(uint32_t tUs)
+{
+  portENTER_CRITICAL(&ctrlStatsMux);
+  ctrlStats.skipped++;
+  if (ctrlLastUs)
+    ctrlLastUs = tUs;
+  portEXIT_CRITICAL(&ctrlStatsMux);
+}
+
+/**
+ * @brief Move deadline watchdog, called by the control task before the trajectory step.
+ *
+ * A move setpoint re-arms it. When `deadline` passes without a new one, the
+ * trajectory is sent to zero (with the deceleration limit); the delay of the
+ * detection is added to the statistics.
+ *
+ * @param tUs Time of the period.
+ * @param newMove A new move setpoint was read in this period.
+ * @param postUs Post time of that setpoint.
+ */
+static void motorsWatchdogCheck(uint32_t tUs, bool newMove, uint32_t postUs)
+{
+  if (newMove)
+  {
+    ctrlWd.moveUs = postUs ? postUs : 1;
+    ctrlWd.tripped = false;
+    ctrlWd.stopping = false;
+  }
+  if (ctrlWd.tripped || !ctrlDeadlineUs || !ctrlWd.moveUs || tUs - ctrlWd.moveUs <= ctrlDeadlineUs)
+    return;
+  ctrlWd.tripped = true;
+  ctrlWd.tripUs = ctrlWd.moveUs + ctrlDeadlineUs;
+  if (!ctrlTraj.out[0] && !ctrlTraj.out[1] && !ctrlTraj.to[0] && !ctrlTraj.to[1])
+    return; // gia' fermo: non conta come intervento
+  motorTrajSet(&ctrlTraj, 0, 0, tUs, false);
+  ctrlWd.stopping = true;
+  uint32_t detect = tUs - ctrlWd.tripUs;
+  portENTER_CRITICAL(&ctrlStatsMux);
+  ctrlStats.wdTrips++;
+  if (detect > ctrlStats.wdDetectMaxUs)
+    ctrlStats.wdDetectMaxUs = detect;
+  portEXIT_CRITICAL(&ctrlStatsMux);
+}
+
+/**
+ * @brief Tells whether the watchdog holds the motors stopped, after the trajectory step.
+ *
+ * Once the deadline passed and the ramp reached zero, the outputs are left
+ * braked or coasting until the next move; the time from the deadline to the
+ * stop is added to the statistics.
+ *
+ * @param tUs Time of the period.
+ * @param out The output of this period, from `motorTrajStep()`.
+ * @return true if the outputs must be left in the stop mode instead of driven.
+ */
+static bool motorsWatchdogHold(uint32_t tUs, const int16_t out[MOTOR_TRAJ_AXES])
+{
+  if (!ctrlWd.tripped || out[0] || out[1])
+    return false;
+  if (ctrlWd.stopping)
+  {
+    ctrlWd.stopping = false;
+    uint32_t stop = tUs - ctrlWd.tripUs;
+    portENTER_CRITICAL(&ctrlStatsMux);
+    ctrlStats.wdStopLastUs = stop;
+    if (stop > ctrlStats.wdStopMaxUs)
+      ctrlStats.wdStopMaxUs = stop;
+    portEXIT_CRITICAL(&ctrlStatsMux);
+  }
+  return true;
+}
+
+/**
+ * @brief Motor control task.
+ *
+ * Woken up every @ref ctrlPeriodUs by @ref ctrlTimer. It reads the newest
+ * setpoint from @ref setpointBuf, advances @ref ctrlTraj towards it
+ * (interpolation between move setpoints, acceleration/deceleration limits)
+ * and drives the outputs with the result; a setpoint of a move command is
+ * reported as applied the first period it is used.
+ *
+ * If no move arrives within `deadline` the task sets a zero setpoint on its
+ * own (ramp with `decel`, see `motorsWatchdogCheck()`), then brakes or
+ * coasts until the next move.
+ * @param arg Unused.
+ */
+static void motorsTask(void *arg)
+{
+  uint32_t lastVer = 0;
+  bool held = false; // modo di stop del watchdog gia' applicato
+  for (;;)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    uint32_t tUs = (uint32_t)esp_timer_get_time();
+    if (xSemaphoreTake(ctrlLock, 0) != pdTRUE)
+    {
+      motorsStatsSkip(tUs); // re-init in corso
+      continue;
+    }
+    MotorsSetpoint sp;
+    uint32_t ver = setpointBuf.read(sp);
+    bool fresh = ver != lastVer;
+    if (ctrlTrajReset)
+    {
+      motorTrajReset(&ctrlTraj);
+      ctrlWd = MotorsWatchdog();
+      ctrlTrajReset = false;
+      fresh = true; // il setpoint corrente riparte come nuovo
+    }
+    if (fresh)
+      motorTrajSet(&ctrlTraj, sp.throttle, sp.steer, tUs, ctrlInterp && sp.posted);
+    motorsWatchdogCheck(tUs, fresh && sp.posted, sp.postUs);
+    uint32_t dtUs = ctrlLastUs ? tUs - ctrlLastUs : ctrlPeriodUs;
+    int16_t out[MOTOR_TRAJ_AXES];
+    motorTrajStep(&ctrlTraj, tUs, dtUs, ctrlAccel, ctrlDecel, out);
+    if (ctrlLutOn)
+      mixLutApply(&ctrlLut, out[0], out[1], out);
+    bool hold = motorsWatchdogHold(tUs, out);
+    if (ctrlReady)
+    {
+      joyY = sp.throttle;
+      joyX = sp.steer;
+      if (!hold)
+        motors.driveTank(out[0], out[1]);
+      else if (!held && ctrlBrake)
+      {
+        motors.brakeA();
+        motors.brakeB();
+      }
+      else if (!held)
+      {
+        motors.coastA();
+        motors.coastB();
+      }
+    }
+    held = hold;
+    xSemaphoreGive(ctrlLock);
+    uint32_t endUs = (uint32_t)esp_timer_get_time();
+    if (fresh && sp.posted)
+    {
+      appliedSeq = sp.seq;
+      portENTER_CRITICAL(&ctrlStatsMux);
+      applyStamp.seq = sp.seq;
+      applyStamp.postUs = sp.postUs;
+      applyStamp.applyUs = endUs;
+      portEXIT_CRITICAL(&ctrlStatsMux);
+    }
+    lastVer = ver;
+    motorsStatsAdd(tUs, endUs - tUs);
+  }
+}
+
+/**
+ * @brief Starts (or restarts) the control task at the configured rate.
+ *
+ * The task, the timer and the lock are created on the first call.
+ * @param hz Control rate.
+ */
+static void motorsCtrlStart(uint16_t hz)
+{
+  if (!ctrlTaskHandle)
+    xTaskCreate(motorsTask, "motors", MOTORS_TASK_STACK, nullptr, MOTORS_TASK_PRIO, &ctrlTaskHandle);
+  if (!ctrlTimer)
+  {
+    esp_timer_create_args_t args = {};
+    args.callback = motorsTimerCb;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "motors";
+    args.skip_unhandled_events = true;
+    esp_timer_create(&args, &ctrlTimer);
+  }
+  else
+    esp_timer_stop(ctrlTimer);
+  portENTER_CRITICAL(&ctrlStatsMux);
+  ctrlPeriodUs = 1000000UL / (hz ? hz : MOTO_DEFAULT_CTRLHZ);
+  ctrlStats = MotorsCtrlStats();
+  latHistReset(&ctrlJitter);
+  ctrlJitterSum = 0;
+  ctrlLastUs = 0;
+  portEXIT_CRITICAL(&ctrlStatsMux);
+  esp_timer_start_periodic(ctrlTimer, ctrlPeriodUs);
+}
+
+/**
+ * @brief Applies deadzone, expo, steering gain and curve.
+ *
+ * With `lutMix` the LUT is rebuilt and the driver gets neutral shaping,
+ * otherwise the driver does the shaping itself. Called with @ref ctrlLock held.
+ * @param cfg The motor configuration.
+ */
+static void motorsApplyShaping(const MotoCfg &cfg)
+{
+  ctrlLutOn = cfg.lutMix;
+  if (ctrlLutOn)
+  {
+    MixLutCfg mc;
+    mc.deadzone = cfg.deadzone;
+    mc.expoPct = cfg.expoPct;
+    mc.steerGain = cfg.SteerGain;
+    if (!mixLutParseCurve(cfg.curve, &mc))
+      DEBUG_PRINTF("MOTORS: curva \"%s\" non valida, uso expo\n", cfg.curve);
+    mixLutBuild(&ctrlLut, &mc);
+  }
+  // con la LUT il driver riceve setpoint gia' sagomati: deadzone, expo e gain neutri
+  motors.setDeadzone(ctrlLutOn ? 0 : cfg.deadzone);
+  motors.setExpoPct(ctrlLutOn ? 0 : cfg.expoPct);
+  motors.setSteerGainPct(ctrlLutOn ? 100 : cfg.SteerGain);
+}
+
+/// @brief Applies the runtime value of one motor parameter; called with @ref ctrlLock held.
+typedef void (*MotorsApplyFn)(const MotoCfg &cfg);
+
+/**
+ * @struct MotorsParamApply
+ * @brief Motor parameter and the function that applies it without re-initializing the driver.
+ */
+typedef struct sMotorsParamApply
+{
+  const char *key;  ///< @brief Parameter key.
+  MotorsApplyFn fn; ///< @brief Apply function.
+} MotorsParamApply;
+
+/// @brief Incremental apply of the motor parameters, see `motorsConfigChanged()`.
+static const MotorsParamApply motorsParamApply[] = {
+    {"maxVel", [](const MotoCfg &c) { motors.setMaxVel(c.maxVel); }},
+    {"deadzone", motorsApplyShaping},
+    {"expoPct", motorsApplyShaping},
+    {"SteerGain", motorsApplyShaping},
+    {"lutMix", motorsApplyShaping},
+    {"curve", motorsApplyShaping},
+    {"arcadeK", [](const MotoCfg &c) { motors.setArcadeLvl(c.arcadeK); }},
+    {"arcadeEnabled", [](const MotoCfg &c) { motors.setArcadeEn(c.arcadeEnabled); }},
+    {"invertA", [](const MotoCfg &c) { motors.setInvertiA(c.invertA); }},
+    {"invertB", [](const MotoCfg &c) { motors.setInvertiB(c.invertB); }},
+    {"tankInvThr", [](const MotoCfg &c) { motors.setInvTankThr(c.tankInvThr); }},
+    {"tankInvStr", [](const MotoCfg &c) { motors.setInvTankStr(c.tankInvStr); }},
+    {"ctrlHz", [](const MotoCfg &c) { motorsCtrlStart(c.ctrlHz); }},
+    {"accel", [](const MotoCfg &c) { ctrlAccel = c.accel; }},
+    {"decel", [](const MotoCfg &c) { ctrlDecel = c.decel; }},
+    {"interp", [](const MotoCfg &c) { ctrlInterp = c.interp; }},
+    {"deadline", [](const MotoCfg &c) { ctrlDeadlineUs = c.deadline * 1000UL; }},
+    {"brake", [](const MotoCfg &c) { ctrlBrake = c.brake; }},
+};
+
+/// @brief Number of entries of @ref motorsParamApply.
+static const int motorsParamApplyCount = sizeof(motorsParamApply) / sizeof(motorsParamApply[0]);
+static_assert(motorsParamApplyCount <= 32, "motorsPending is a 32 bit mask");
+
+/// @brief Parameters changed and not yet applied, one bit per entry of @ref motorsParamApply.
+static volatile uint32_t motorsPending = 0;
+/// @brief Protects @ref motorsPending (AsyncTCP task and main loop).
+static portMUX_TYPE motorsPendingMux = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Records a changed motor parameter (callback of `configOnChange()`).
+ *
+ * Runs in the writer's task: the value is applied by `motorsTick()`. A key
+ * without an apply function asks for the full re-initialization.
+ * @param key The parameter key.
+ */
+static void motorsConfigChanged(const char *key)
+{
+  for (int i = 0; i < motorsParamApplyCount; i++)
+  {
+    if (strcmp(motorsParamApply[i].key, key) == 0)
+    {
+      portENTER_CRITICAL(&motorsPendingMux);
+      motorsPending |= 1UL << i;
+      portEXIT_CRITICAL(&motorsPendingMux);
+      return;
+    }
+  }
+  motorsReinit = true;
+}
+
 /**
  * @brief Initializes the motors with configuration settings.
  *
  * This function reads motor configuration from `configGetMotoCfg()`,
  * sets up the motor controller, applies all the configuration parameters,
- * and sets the motors to a coast state.
+ * sets the motors to a coast state and (re)starts the control task at
+ * `ctrlHz`. The setpoint is reset to zero.
  */
 void motorsInit()
 {
+  configOnChange(MOTO_PREF_NS, motorsConfigChanged);
+  portENTER_CRITICAL(&motorsPendingMux);
+  motorsPending = 0; // li applica tutti la re-init
+  portEXIT_CRITICAL(&motorsPendingMux);
   MotoCfg cfg = configGetMotoCfg();
   motorsReinit = false;
   joyX = 0;
   joyY = 0;
+  motorsApply(0, 0);
 
-  if (!motors.begin())
+  if (!ctrlLock)
+    ctrlLock = xSemaphoreCreateMutex();
+  xSemaphoreTake(ctrlLock, portMAX_DELAY);
+  ctrlAccel = cfg.accel;
+  ctrlDecel = cfg.decel;
+  ctrlInterp = cfg.interp;
+  ctrlDeadlineUs = cfg.deadline * 1000UL;
+  ctrlBrake = cfg.brake;
+  ctrlTrajReset = true;
+  ctrlReady = motors.begin();
+  if (!ctrlReady)
   {
+    xSemaphoreGive(ctrlLock);
     DEBUG_PRINTLN("Errore MOTORS (pin/Canali/freq non validi).");
     return;
   }
 
   motors.setMaxVel(cfg.maxVel);
-  motors.setDeadzone(cfg.deadzone);
-  motors.setExpoPct(cfg.expoPct);
-  motors.setSteerGainPct(cfg.SteerGain);
+  motorsApplyShaping(cfg);
   motors.setArcadeLvl(cfg.arcadeK);
   motors.setArcadeEn(cfg.arcadeEnabled);
   motors.setInvertiA(cfg.invertA);
@@ -100,6 +506,8 @@ void motorsInit()
   motors.setInvTankStr(cfg.tankInvStr);
   motors.coastA();
   motors.coastB();
+  xSemaphoreGive(ctrlLock);
+  motorsCtrlStart(cfg.ctrlHz);
   motorsPrintConfig();
 }
 
@@ -114,41 +522,91 @@ void motorsReload(void)
 }
 
 /**
- * @brief Applies new throttle and steer values to the motors.
+ * @brief Writes a setpoint into the double buffer.
+ *
+ * @param sp The setpoint.
+ */
+static void motorsWrite(const MotorsSetpoint &sp)
+{
+  portENTER_CRITICAL(&setpointMux);
+  setpointBuf.write(sp);
+  portEXIT_CRITICAL(&setpointMux);
+}
+
+/**
+ * @brief Sets new throttle and steer values.
  *
- * This function updates the global joystick variables and then commands the
- * motors to drive using a tank-style control scheme.
+ * The control task drives the motors with them, using a tank-style control
+ * scheme, at its next period.
  *
  * @param throttle The throttle value, typically from -100 to 100.
  * @param steer The steering value, typically from -100 to 100.
  */
 void motorsApply(int16_t throttle, int16_t steer)
 {
-  joyY = throttle;
-  joyX = steer;
-  motors.driveTank(joyY, joyX);
+  MotorsSetpoint sp;
+  sp.throttle = throttle;
+  sp.steer = steer;
+  motorsWrite(sp);
+}
+
+/**
+ * @brief Posts a new setpoint from a move command.
+ *
+ * @param throttle The throttle value.
+ * @param steer The steering value.
+ * @param seq The sequence number of the command (0 if the sender has none).
+ */
+void motorsPost(int16_t throttle, int16_t steer, uint16_t seq)
+{
+  MotorsSetpoint sp;
+  sp.throttle = throttle;
+  sp.steer = steer;
+  sp.seq = seq;
+  sp.postUs = (uint32_t)esp_timer_get_time();
+  sp.posted = true;
+  motorsWrite(sp);
 }
 
 /**
- * @brief A periodic update function for the motors.
+ * @brief Applies the changed motor parameters.
  *
- * This function checks if a certain amount of time has passed since the last
- * motor command was sent. If so, it calls `motorsApply()` to re-apply the
- * last known joystick values, ensuring a constant motor state.
+ * Only the setters of the changed keys are called, under @ref ctrlLock, so
+ * the control task keeps running with its trajectory. The full
+ * re-initialization (`motors.begin()`, setpoint to zero, coast) is left to
+ * `motorsReload()` and to a driver that failed to start.
  */
 void motorsTick()
 {
-  if (motorsReinit)
+  uint32_t pending;
+  portENTER_CRITICAL(&motorsPendingMux);
+  pending = motorsPending;
+  motorsPending = 0;
+  portEXIT_CRITICAL(&motorsPendingMux);
+
+  if (motorsReinit || (pending && !ctrlReady))
   {
     motorsInit();
     return;
   }
-  uint32_t now = millis();
-  if (now - lastMoveApplyMs >= 100)
+  if (!pending)
+    return;
+
+  MotoCfg cfg = configGetMotoCfg();
+  xSemaphoreTake(ctrlLock, portMAX_DELAY);
+  for (int i = 0; pending; i++)
   {
-    lastMoveApplyMs = now;
-    motorsApply(joyY, joyX);
+    if (!(pending & (1UL << i)))
+      continue;
+    // chiavi con la stessa funzione (deadzone/expo/gain/curva): un solo ricalcolo
+    MotorsApplyFn fn = motorsParamApply[i].fn;
+    for (int j = i; j < motorsParamApplyCount; j++)
+      if (motorsParamApply[j].fn == fn)
+        pending &= ~(1UL << j);
+    fn(cfg);
+    DEBUG_PRINTF("MOTORS: %s applicato\n", motorsParamApply[i].key);
   }
+  xSemaphoreGive(ctrlLock);
 }
 
 /**
@@ -165,6 +623,46 @@ int16_t motorsGetThrottle(){return joyY;};
  */
 int16_t motorsGetSteer(){return joyX;};
 
+/**
+ * @brief Gets the sequence number of the last setpoint applied from a move command.
+ *
+ * @return The last applied sequence number.
+ */
+uint16_t motorsGetAppliedSeq() { return appliedSeq; }
+
+/**
+ * @brief Gets the timing of the last setpoint applied from a move command.
+ *
+ * @return Sequence number, post and apply timestamps of the setpoint.
+ */
+MotorsApplyStamp motorsGetApplyStamp()
+{
+  portENTER_CRITICAL(&ctrlStatsMux);
+  MotorsApplyStamp s = applyStamp;
+  portEXIT_CRITICAL(&ctrlStatsMux);
+  return s;
+}
+
+/**
+ * @brief Gets the timing statistics of the motor control task.
+ *
+ * @return A copy of the statistics.
+ */
+MotorsCtrlStats motorsGetCtrlStats()
+{
+  static LatHist h; // copia fuori dalla sezione critica: il percentile scorre 80 bucket
+  portENTER_CRITICAL(&ctrlStatsMux);
+  MotorsCtrlStats st = ctrlStats;
+  h = ctrlJitter;
+  uint64_t sum = ctrlJitterSum;
+  st.periodUs = ctrlPeriodUs;
+  portEXIT_CRITICAL(&ctrlStatsMux);
+  if (st.ticks > 1)
+    st.jitterAvgUs = (uint32_t)(sum / (st.ticks - 1));
+  st.jitterP99Us = latHistPercentile(&h, 99);
+  return st;
+}
+
 /**
  * @brief Gets the last target value set for motor A.
  *
@@ -34,6 +34,101 @@ AsyncWebServer server(80);
 /// @brief Global instance of the WebSocket, initialized with the "/ws" URL.
 AsyncWebSocket ws("/ws");
 
+/**
+ * @brief Parses an HTTP "Range" header with a single byte range.
+ *
+ * Accepts `bytes=a-b`, `bytes=a-` and `bytes=-n` (the last n bytes).
+ * @param range The header value.
+ * @param size Size of the resource.
+ * @param start Receives the first byte of the range.
+ * @param len Receives the length of the range.
+ * @return false if the range is malformed or outside the resource.
+ */
+static bool netParseRange(const String &range, size_t size, size_t &start, size_t &len)
+{
+  if (!range.startsWith("bytes=") || range.indexOf(',') >= 0)
+    return false;
+  int dash = range.indexOf('-');
+  if (dash < 6)
+    return false;
+  String a = range.substring(6, dash);
+  String b = range.substring(dash + 1);
+  a.trim();
+  b.trim();
+  size_t first, last;
+  if (a.length() == 0)
+  {
+    // suffisso: gli ultimi n byte
+    size_t n = strtoul(b.c_str(), nullptr, 10);
+    if (!n || !b.length())
+      return false;
+    first = n < size ? size - n : 0;
+    last = size - 1;
+  }
+  else
+  {
+    first = strtoul(a.c_str(), nullptr, 10);
+    last = b.length() ? strtoul(b.c_str(), nullptr, 10) : size - 1;
+    if (last >= size)
+      last = size - 1;
+  }
+  if (first >= size || last < first)
+    return false;
+  start = first;
+  len = last - first + 1;
+  return true;
+}
+
+/**
+ * @brief Serves the flight recorder log, with support for range requests.
+ *
+ * While a recording is running only the blocks already written are served,
+ * so a download never ends in the middle of a block. The file is streamed in
+ * chunks from the AsyncTCP task, never loaded in RAM.
+ * @param request The HTTP request.
+ */
+static void netSendBlackbox(AsyncWebServerRequest *request)
+{
+#ifdef CONFIG_PARTITION_USE_SPIFFS
+  File f = SPIFFS.open(BLACKBOX_FILE, FILE_READ);
+#else
+  File f = LittleFS.open(BLACKBOX_FILE, FILE_READ);
+#endif
+  if (!f)
+  {
+    request->send(404, "text/plain", "No recording");
+    return;
+  }
+  BlackboxStatus st = blackboxGetStatus();
+  size_t size = st.recording ? st.bytes : f.size();
+  size_t start = 0, len = size;
+  bool partial = request->hasHeader("Range");
+  if (partial && !netParseRange(request->getHeader("Range")->value(), size, start, len))
+  {
+    AsyncWebServerResponse *r = request->beginResponse(416, "text/plain", "Range Not Satisfiable");
+    r->addHeader("Content-Range", "bytes */" + String(size));
+    request->send(r);
+    return;
+  }
+  AsyncWebServerResponse *response = request->beginResponse(
+      "application/octet-stream", len, [f, start, len](uint8_t *buf, size_t maxLen, size_t index) mutable -> size_t
+      {
+        if (index >= len)
+          return 0;
+        size_t n = len - index < maxLen ? len - index : maxLen;
+        if (!f.seek(start + index))
+          return 0;
+        return f.read(buf, n); });
+  response->addHeader("Accept-Ranges", "bytes");
+  response->addHeader("Cache-Control", "no-cache");
+  if (partial)
+  {
+    response->setCode(206);
+    response->addHeader("Content-Range", "bytes " + String(start) + "-" + String(start + len - 1) + "/" + String(size));
+  }
+  request->send(response);
+}
+
 /**
  * @brief Initializes the web server and its handlers.
  *
@@ -48,6 +143,9 @@ void netInit()
   DefaultHeaders::Instance().addHeader("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS");
   DefaultHeaders::Instance().addHeader("Access-Control-Allow-Headers", "*");
 
+  // Scatola nera: prima di serveStatic, che altrimenti servirebbe il file senza Range
+  server.on(BLACKBOX_FILE, HTTP_GET, netSendBlackbox);
+
 // Servi la UI statica (index.html)
 #ifdef CONFIG_PARTITION_USE_SPIFFS
   server.serveStatic("/", SPIFFS, "/").setDefaultFile("Index.html").setCacheControl("no-cache");
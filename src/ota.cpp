@@ -36,8 +36,8 @@ static uint32_t lastProgMs = 0; // La variabile globale
 /**
  * @brief Sends an OTA message to all connected WebSocket clients.
  *
- * This function serializes a JSON document and broadcasts it to all clients
- * connected to the `ws` server.
+ * This function serializes a JSON document and queues it, with event priority,
+ * on the outbound queue of the clients subscribed to the "ota" topic.
  *
  * @param fill A lambda function that populates the JSON document with the desired fields.
  */
@@ -48,7 +48,7 @@ static void wsBroadcastOta(std::function<void(JsonDocument &)> fill)
   fill(doc);
   String s;
   serializeJson(doc, s);
-  ws.textAll(s);
+  websocketPublish(WS_TOPIC_OTA, s);
 }
 
 /**
@@ -36,27 +36,431 @@ uint32_t SENSOR_PERIOD_MS = 100;
 static ROBORA_42670 IMU;
 /// @brief Variable to store the latest IMU data frame.
 _sRobOra_42670_IMU imuFrame;
-/// @brief Timestamp for the last IMU update, used for rate limiting.
 /// @brief Indicates whether the IMU initialization was successful
 bool imuSuccessful;
 /// @brief Indicates the IMU re-initialization
 bool imuReinit = false;
 
-/// @brief Battery voltage
-float batteryVoltage = 0;
+
+/// @brief Timestamped samples from the acquisition task to `telemetryTick()`.
+static SpscRing<ImuSample, IMU_RING_SIZE> imuRing;
+/// @brief Handle of the IMU acquisition task.
+static TaskHandle_t imuTaskHandle = nullptr;
+/// @brief Periodic timer that wakes up the acquisition task.
+static esp_timer_handle_t imuTimer = nullptr;
+/// @brief Serializes the access to @ref IMU between `telemetryInit()` and the acquisition task.
+static SemaphoreHandle_t imuLock = nullptr;
+
+/// @brief Spinlock protecting the statistics below.
+static portMUX_TYPE imuStatsMux = portMUX_INITIALIZER_UNLOCKED;
+/// @brief Timing statistics (jitter percentiles are computed from @ref imuJitter).
+static ImuStats imuStats;
+/// @brief Rolling histogram of the sample period jitter.
+static LatHist imuJitter;
+/// @brief Sum of the jitter, for the mean.
+static uint64_t imuJitterSum = 0;
+/// @brief Timestamp of the previous sample (0 = none since the last start).
+static uint32_t imuLastUs = 0;
+/// @brief Nominal wake-up period of the acquisition task.
+static uint32_t imuPeriodUs = IMU_SAMPLE_PERIOD_US;
+/// @brief ODR of the hardware FIFO in Hz, 0 = register mode (`IMU.Loop()`).
+static uint16_t imuFifoOdr = 0;
+/**
+ * @brief Attitude filter to (re)start, -1 = none.
+ *
+ * Posted by the main loop, applied by the IMU task before its next FIFO
+ * drain: the filter state is only touched by the IMU task (see attitude.h).
+ */
+static std::atomic<int> imuFilterReq{-1};
+
+/// @brief Channels aggregated over the broadcast window (bit i = `sens<i>`).
+static uint8_t teleAggMask = 0;
+
+/// @brief Delta mode: only the channels beyond their deadband are sent, plus keyframes.
+static bool teleDelta = false;
+/// @brief Keyframe period in delta mode (ms).
+static uint32_t teleKeyMs = TELE_DEFAULT_KEYMS;
+/// @brief Deadband of the channels `sens0..sens4`, in the units of @ref WsBinSensor.
+static uint16_t teleDeadband[TELE_DELTA_CHANNELS];
+/// @brief Tilt alarm threshold (0.01 deg, 0 = off).
+static int32_t teleAlrTilt = 0;
+/// @brief Low battery alarm threshold (mV, 0 = off).
+static int32_t teleAlrBatt = 0;
+/// @brief Active alarms (@ref WsSensorAlarm).
+static uint8_t teleAlarm = 0;
+
+/**
+ * @struct TeleRate
+ * @brief Telemetry state of the clients that share one period.
+ *
+ * Each client of the "sensor" topic has its own period; the clients with the
+ * same period form a group, whose messages are built once from the shared
+ * IMU snapshot and sent to all of them. Deltas and aggregate windows are
+ * per group, so a slow client still gets the peaks of its whole window.
+ */
+typedef struct sTeleRate
+{
+  uint16_t periodMs = 0;                   ///< @brief Period of the group.
+  uint32_t lastMs = 0;                     ///< @brief `millis()` of the last send.
+  bool lastValid = false;                  ///< @brief false until the first keyframe of the group.
+  uint32_t lastKeyMs = 0;                  ///< @brief `millis()` of the last keyframe.
+  int32_t lastSent[TELE_DELTA_CHANNELS];   ///< @brief Last value sent of each channel, units of @ref WsBinSensor.
+  AggStat agg[TELE_AGG_CHANNELS];          ///< @brief Window aggregates of `sens0..sens3`, reset after every send.
+} TeleRate;
+
+/// @brief Period groups of the "sensor" subscribers (at most one per client).
+static TeleRate teleRates[WS_MAX_CLIENTS];
+/// @brief Number of valid entries of @ref teleRates.
+static uint8_t teleRateCount = 0;
+
+/// @brief Period of the attitude stream (ms), 0 = off.
+static uint32_t teleAttMs = 0;
+/// @brief Quaternion of the newest IMU sample (Q14), all 0 in register mode.
+static int16_t imuQuat[4] = {0, 0, 0, 0};
+/// @brief Timestamp of the newest IMU sample.
+static uint32_t imuQuatUs = 0;
+
+/// @brief History ring, one record per telemetry period (heap, "histKB" budget).
+static WsBinHistRec *teleHist = nullptr;
+/// @brief Capacity of @ref teleHist in records.
+static uint16_t teleHistCap = 0;
+/// @brief Index of the next record to write.
+static uint16_t teleHistHead = 0;
+/// @brief Number of valid records.
+static uint16_t teleHistCount = 0;
+
+/**
+ * @brief Timer callback: wakes up the IMU acquisition task.
+ *
+ * Runs in the esp_timer task, so it only sends a notification.
+ * @param arg Unused.
+ */
+static void imuTimerCb(void *arg)
+{
+  if (imuTaskHandle)
+    xTaskNotifyGive(imuTaskHandle);
+}
+
+/**
+ * @brief Updates the timing statistics with a new sample.
+ *
+ * @param tUs Timestamp of the sample.
+ */
+static void imuStatsAdd(uint32_t tUs)
+{
+  portENTER_CRITICAL(&imuStatsMux);
+  imuStats.samples++;
+  if (imuLastUs)
+  {
+    uint32_t period = tUs - imuLastUs;
+    uint32_t jitter = (period > imuPeriodUs) ? period - imuPeriodUs : imuPeriodUs - period;
+    if (imuStats.periodMinUs == 0 || period < imuStats.periodMinUs)
+      imuStats.periodMinUs = period;
+    if (period > imuStats.periodMaxUs)
+      imuStats.periodMaxUs = period;
+    if (jitter > imuStats.jitterMaxUs)
+      imuStats.jitterMaxUs = jitter;
+    imuJitterSum += jitter;
+    latHistAdd(&imuJitter, jitter);
+  }
+  imuLastUs = tUs;
+  portEXIT_CRITICAL(&imuStatsMux);
+}
+
+/**
+ * @brief Drains the IMU hardware FIFO (called by the task with @ref imuLock held).
+ *
+ * Every decoded packet goes through the attitude filter and becomes one
+ * @ref ImuSample. The packets are spaced by 1/ODR, so the timestamps are
+ * back-computed from the time of the read (the newest packet is at most one
+ * period older than that).
+ * @param tUs Time of the read.
+ */
+static void imuFifoDrain(uint32_t tUs)
+{
+  static ImuRaw raw[IMU_FIFO_MAX_BATCH];
+  size_t n = imuFifoRead(raw, IMU_FIFO_MAX_BATCH);
+  xSemaphoreGive(imuLock);
+
+  const uint32_t samplePeriodUs = 1000000UL / imuFifoOdr;
+  for (size_t i = 0; i < n; i++)
+  {
+    attitudeUpdate(raw[i]);
+    Attitude a = attitudeGet();
+    ImuSample s;
+    s.tUs = tUs - (uint32_t)(n - 1 - i) * samplePeriodUs;
+    s.frame = _sRobOra_42670_IMU{};
+    s.frame.Kal[0] = a.pitch;
+    s.frame.Kal[1] = a.roll;
+    s.frame.Kal[2] = a.yaw;
+    s.frame.Temperature = raw[i].temp / 2.0f + 25.0f;
+    for (int k = 0; k < 4; k++)
+      s.q[k] = (int16_t)((a.q[k] + (1 << 15)) >> 16); // Q30 -> Q14
+    imuRing.push(s);
+  }
+}
+
+/**
+ * @brief IMU acquisition task.
+ *
+ * Woken up every @ref imuPeriodUs by @ref imuTimer. In register mode it reads
+ * the IMU through the driver, timestamps the sample and pushes it into
+ * @ref imuRing; in FIFO mode it drains the hardware FIFO with burst reads
+ * (see `imuFifoDrain()`), after applying a filter change posted in
+ * @ref imuFilterReq. The I2C access is serialized with the display by the
+ * Wire driver lock, and with `telemetryInit()` by @ref imuLock; the attitude
+ * filter is only updated here, outside the lock.
+ * @param arg Unused.
+ */
+static void imuTask(void *arg)
+{
+  for (;;)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    if (xSemaphoreTake(imuLock, 0) != pdTRUE)
+      continue; // re-init in corso
+    uint32_t tUs = (uint32_t)esp_timer_get_time();
+    if (imuFifoOdr)
+    {
+      int f = imuFilterReq.exchange(-1);
+      if (f >= 0)
+        attitudeReset((FusionFilter)f, imuFifoOdr);
+      imuFifoDrain(tUs); // rilascia imuLock
+    }
+    else
+    {
+      ImuSample s;
+      s.tUs = tUs;
+      IMU.Loop();
+      s.frame = IMU.Get_ALL();
+      memset(s.q, 0, sizeof(s.q));
+      xSemaphoreGive(imuLock);
+      imuRing.push(s);
+    }
+    imuStatsAdd(tUs);
+  }
+}
+
+/**
+ * @brief Starts (or restarts) the periodic IMU acquisition.
+ *
+ * The task and the timer are created on the first call.
+ */
+static void imuStart()
+{
+  if (!imuTaskHandle)
+    xTaskCreate(imuTask, "imu", IMU_TASK_STACK, nullptr, IMU_TASK_PRIO, &imuTaskHandle);
+  if (!imuTimer)
+  {
+    esp_timer_create_args_t args = {};
+    args.callback = imuTimerCb;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "imu";
+    args.skip_unhandled_events = true;
+    esp_timer_create(&args, &imuTimer);
+  }
+  portENTER_CRITICAL(&imuStatsMux);
+  imuStats = ImuStats();
+  latHistReset(&imuJitter);
+  imuJitterSum = 0;
+  imuLastUs = 0;
+  portEXIT_CRITICAL(&imuStatsMux);
+  esp_timer_start_periodic(imuTimer, imuPeriodUs);
+}
+
+/**
+ * @brief Gets the timing statistics of the IMU acquisition task.
+ *
+ * @return A copy of the statistics.
+ */
+ImuStats telemetryGetImuStats()
+{
+  static LatHist h; // copia fuori dalla sezione critica: il percentile scorre 80 bucket
+  portENTER_CRITICAL(&imuStatsMux);
+  ImuStats st = imuStats;
+  h = imuJitter;
+  uint64_t sum = imuJitterSum;
+  portEXIT_CRITICAL(&imuStatsMux);
+  st.dropped = imuRing.drops();
+  if (st.samples > 1)
+    st.jitterAvgUs = (uint32_t)(sum / (st.samples - 1));
+  st.jitterP99Us = latHistPercentile(&h, 99);
+  return st;
+}
+
+/**
+ * @brief (Re)allocates the history ring for a memory budget.
+ *
+ * The ring is kept if the capacity does not change, otherwise it is freed and
+ * allocated again empty. If the allocation fails the history stays off.
+ * @param kb Budget in KB, 0 = history off.
+ */
+static void telemetryHistoryAlloc(uint8_t kb)
+{
+  uint16_t cap = (uint16_t)((uint32_t)kb * 1024 / sizeof(WsBinHistRec));
+  if (cap == teleHistCap)
+    return;
+  free(teleHist);
+  teleHist = cap ? (WsBinHistRec *)malloc((size_t)cap * sizeof(WsBinHistRec)) : nullptr;
+  teleHistCap = teleHist ? cap : 0;
+  teleHistHead = 0;
+  teleHistCount = 0;
+  if (cap && !teleHist)
+    DEBUG_PRINTF("Telemetry history: alloc %u KB failed\n", kb);
+}
+
+/// @brief Applies the runtime value of one telemetry parameter, from the main loop.
+typedef void (*TeleApplyFn)(const TeleCfg &cfg);
+
+/**
+ * @struct TeleParamApply
+ * @brief Telemetry parameter and the function that applies it without touching the IMU.
+ */
+typedef struct sTeleParamApply
+{
+  const char *key; ///< @brief Parameter key.
+  TeleApplyFn fn;  ///< @brief Apply function, nullptr = full re-initialization (IMU/I2C).
+} TeleParamApply;
+
+/// @brief Incremental apply of the telemetry parameters, see `telemetryConfigChanged()`.
+static const TeleParamApply teleParamApply[] = {
+    {"enable", nullptr},
+    {"fifo", nullptr},
+    {"odr", nullptr},
+    {"refresh", [](const TeleCfg &c)
+     {
+       SENSOR_PERIOD_MS = c.refresh;
+       websocketSetTopicPeriod(WS_TOPIC_SENSOR, c.refresh ? c.refresh : 1);
+     }},
+    {"aggMask", [](const TeleCfg &c)
+     {
+       teleAggMask = c.aggMask & ((1u << TELE_AGG_CHANNELS) - 1);
+       teleRateCount = 0; // finestre e keyframe ripartono
+     }},
+    {"delta", [](const TeleCfg &c)
+     {
+       teleDelta = c.delta;
+       teleRateCount = 0;
+     }},
+    {"keyMs", [](const TeleCfg &c) { teleKeyMs = c.keyMs; }},
+    {"dbAngle", [](const TeleCfg &c) { teleDeadband[0] = teleDeadband[1] = teleDeadband[2] = c.dbAngle; }},
+    {"dbTemp", [](const TeleCfg &c) { teleDeadband[3] = c.dbTemp; }},
+    {"dbBatt", [](const TeleCfg &c) { teleDeadband[4] = c.dbBatt; }},
+    {"alrTilt", [](const TeleCfg &c)
+     {
+       teleAlrTilt = (int32_t)c.alrTilt * 100;
+       teleAlarm = 0;
+     }},
+    {"alrBatt", [](const TeleCfg &c)
+     {
+       teleAlrBatt = c.alrBatt;
+       teleAlarm = 0;
+     }},
+    {"filter", [](const TeleCfg &c)
+     {
+       // lo stato del filtro e' del task IMU: lo riavvia lui prima del prossimo svuotamento
+       imuFilterReq.store(c.filter);
+     }},
+    {"attHz", [](const TeleCfg &c) { teleAttMs = c.attHz ? 1000 / c.attHz : 0; }},
+    {"histKB", [](const TeleCfg &c) { telemetryHistoryAlloc(c.histKB); }},
+    {"bbKB", [](const TeleCfg &) {}}, // letto da blackboxStart() a ogni registrazione
+};
+
+/// @brief Number of entries of @ref teleParamApply.
+static const int teleParamApplyCount = sizeof(teleParamApply) / sizeof(teleParamApply[0]);
+static_assert(teleParamApplyCount <= 32, "telePending is a 32 bit mask");
+
+/// @brief Parameters changed and not yet applied, one bit per entry of @ref teleParamApply.
+static volatile uint32_t telePending = 0;
+/// @brief Protects @ref telePending (AsyncTCP task and main loop).
+static portMUX_TYPE telePendingMux = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Records a changed telemetry parameter (callback of `configOnChange()`).
+ *
+ * Runs in the writer's task: the value is applied by `telemetryTick()`. The
+ * keys that reconfigure the IMU (and unknown keys) ask for the full
+ * re-initialization.
+ * @param key The parameter key.
+ */
+static void telemetryConfigChanged(const char *key)
+{
+  for (int i = 0; i < teleParamApplyCount; i++)
+  {
+    if (strcmp(teleParamApply[i].key, key) != 0)
+      continue;
+    if (!teleParamApply[i].fn)
+      break;
+    portENTER_CRITICAL(&telePendingMux);
+    telePending |= 1UL << i;
+    portEXIT_CRITICAL(&telePendingMux);
+    return;
+  }
+  imuReinit = true;
+}
+
+/**
+ * @brief Applies the telemetry parameters recorded by `telemetryConfigChanged()`.
+ */
+static void telemetryApplyPending()
+{
+  uint32_t pending;
+  portENTER_CRITICAL(&telePendingMux);
+  pending = telePending;
+  telePending = 0;
+  portEXIT_CRITICAL(&telePendingMux);
+  if (!pending)
+    return;
+
+  TeleCfg cfg = configGetTeleCfg();
+  for (int i = 0; i < teleParamApplyCount; i++)
+  {
+    if (pending & (1UL << i))
+    {
+      teleParamApply[i].fn(cfg);
+      DEBUG_PRINTF("Telemetry: %s applicato\n", teleParamApply[i].key);
+    }
+  }
+}
 
 /**
  * @brief Initializes the I2C bus and the IMU sensor.
  *
  * Sets up the I2C communication on pins 5 (SDA) and 6 (SCL) for an ESP32-C3
- * and initializes the IMU at a frequency of 400kHz.
+ * and initializes the IMU at a frequency of 400kHz. When the IMU answers, the
+ * acquisition task is (re)started: every @ref IMU_SAMPLE_PERIOD_US in register
+ * mode, every @ref IMU_FIFO_DRAIN_US when the hardware FIFO is enabled
+ * ("fifo" parameter, at the "odr" rate).
  */
 void telemetryInit()
 {
+  configOnChange(TELE_PREF_NS, telemetryConfigChanged);
+  portENTER_CRITICAL(&telePendingMux);
+  telePending = 0; // li applica tutti la re-init
+  portEXIT_CRITICAL(&telePendingMux);
   TeleCfg cfg = configGetTeleCfg();
   SENSOR_PERIOD_MS = cfg.refresh;
   EnableTelemetry = cfg.enable;
+  teleAggMask = cfg.aggMask & ((1u << TELE_AGG_CHANNELS) - 1);
+  teleRateCount = 0;
+  websocketSetTopicPeriod(WS_TOPIC_SENSOR, cfg.refresh ? cfg.refresh : 1);
+  teleDelta = cfg.delta;
+  teleKeyMs = cfg.keyMs;
+  teleDeadband[0] = teleDeadband[1] = teleDeadband[2] = cfg.dbAngle;
+  teleDeadband[3] = cfg.dbTemp;
+  teleDeadband[4] = cfg.dbBatt;
+  teleAlrTilt = (int32_t)cfg.alrTilt * 100;
+  teleAlrBatt = cfg.alrBatt;
+  teleAlarm = 0;
+  teleAttMs = cfg.attHz ? 1000 / cfg.attHz : 0;
+  telemetryHistoryAlloc(cfg.histKB);
   imuReinit = false;
+
+  if (!imuLock)
+    imuLock = xSemaphoreCreateMutex();
+  if (imuTimer)
+    esp_timer_stop(imuTimer);
+  xSemaphoreTake(imuLock, portMAX_DELAY);
   if (cfg.enable)
   {
     if (IMU.Init(Wire, true) == 0)
@@ -65,10 +469,23 @@ void telemetryInit()
       imuSuccessful = false;
     DEBUG_PRINTF("IMU initialization : %s\n", imuSuccessful ? "OK" : "KO");
   }
+  if (imuFifoOdr && imuSuccessful && !(cfg.enable && cfg.fifo))
+    imuFifoEnd();
+  imuFifoOdr = 0;
+  if (cfg.enable && imuSuccessful && cfg.fifo)
+  {
+    imuFifoOdr = imuFifoBegin(cfg.odr); // 0 se fallisce: si resta in modalità registri
+    if (imuFifoOdr)
+      imuFilterReq.store(cfg.filter); // il task IMU puo' avere un batch ancora in corso
+  }
+  imuPeriodUs = imuFifoOdr ? IMU_FIFO_DRAIN_US : IMU_SAMPLE_PERIOD_US;
+  xSemaphoreGive(imuLock);
+  imuRing.clear();
+  if (cfg.enable && imuSuccessful)
+    imuStart();
 
-  /*Adc Configure*/
-  analogReadResolution(12);       // 12 bit
-  analogSetAttenuation(ADC_11db); // Set maximum attenuation (~2.5V max)
+  /*Adc Configure: batteria campionata in continuo via DMA*/
+  adcContInit();
 }
 
 /**
@@ -84,6 +501,7 @@ void telemetryInit()
  *
  * @param Pin The GPIO pin number (uint8_t) configured as an analog input 
  * @return float The actual voltage measured at the source (V_in), in Volts.
+ * @note Blocking one-shot read: not for the pins of @ref ADC_CONT_PINS, use `adcContGetMv()`.
  */
 float telemetryReadAdC(uint8_t Pin)
 {
@@ -95,7 +513,10 @@ float telemetryReadAdC(uint8_t Pin)
 /**
  * @brief Re-Initializes the IMU and telemetry systems
  *
- * This function sets up the I2C bus and re-initializes the IMU sensor
+ * This function sets up the I2C bus and re-initializes the IMU sensor.
+ * A parameter written with `configPut*()` does not need it: only "enable",
+ * "fifo" and "odr" re-initialize the IMU, the others are applied by
+ * `telemetryTick()` without touching the sensor.
  */
 void telemetryReload()
 {
@@ -103,102 +524,528 @@ void telemetryReload()
 }
 
 /**
- * @brief Updates the IMU data at a fixed interval.
+ * @brief Converts a value to fixed point, saturated to the int16 range.
  *
- * This function is called frequently and updates the IMU data frame every 10 milliseconds
- * to ensure fresh readings.
+ * @param v The value.
+ * @param scale The fixed-point scale (e.g. 100 for hundredths).
+ * @return The scaled and rounded value.
+ */
+static int16_t telemetryFix16(float v, float scale)
+{
+  float f = v * scale;
+  if (f > 32767.0f)
+    return 32767;
+  if (f < -32768.0f)
+    return -32768;
+  return (int16_t)lroundf(f);
+}
+
+/**
+ * @brief Collects the IMU samples of the acquisition task.
+ *
+ * Drains the timestamped samples queued by `imuTask()` and keeps the newest
+ * one in `imuFrame`. Every sample also updates the window aggregates of the
+ * selected channels, so the peaks between two broadcasts are not lost, and
+ * is queued for the flight recorder while a recording is running.
  */
 static void imuLoop()
 {
-  if (imuReinit)
+  ImuSample s;
+  while (imuRing.pop(s))
   {
-    telemetryInit();
-    return;
+    imuFrame = s.frame;
+    memcpy(imuQuat, s.q, sizeof(imuQuat));
+    imuQuatUs = s.tUs;
+    if (blackboxRecording())
+    {
+      // solo una copia nel ring: compressione e flash nel task della scatola nera
+      BlackboxSample b;
+      b.tUs = s.tUs;
+      b.angle[0] = telemetryFix16(s.frame.Kal[0], 100.0f);
+      b.angle[1] = telemetryFix16(-s.frame.Kal[1], 100.0f);
+      b.angle[2] = telemetryFix16(s.frame.Kal[2], 100.0f);
+      b.temp = telemetryFix16(s.frame.Temperature, 100.0f);
+      memcpy(b.q, s.q, sizeof(b.q));
+      blackboxLog(b);
+    }
+    if (!teleAggMask)
+      continue;
+    const float ch[TELE_AGG_CHANNELS] = {s.frame.Kal[0], -s.frame.Kal[1], s.frame.Kal[2], s.frame.Temperature};
+    for (uint8_t g = 0; g < teleRateCount; g++)
+      for (uint8_t i = 0; i < TELE_AGG_CHANNELS; i++)
+        if (teleAggMask & (1u << i))
+          aggStatAdd(&teleRates[g].agg[i], ch[i]);
+  }
+}
+
+/**
+ * @brief Appends formatted text to a buffer without ever writing past its end.
+ *
+ * @param buf The buffer.
+ * @param size Size of the buffer.
+ * @param len Current length, updated; at most `size - 1`.
+ * @param fmt The `printf` format.
+ * @return false if the text did not fit (the buffer keeps what fitted).
+ */
+static bool telemetryAppend(char *buf, size_t size, size_t *len, const char *fmt, ...)
+{
+  if (*len + 1 >= size)
+    return false;
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(buf + *len, size - *len, fmt, ap);
+  va_end(ap);
+  if (n < 0 || (size_t)n >= size - *len)
+  {
+    *len = size - 1;
+    return false;
   }
+  *len += n;
+  return true;
+}
 
-  batteryVoltage = telemetryReadAdC(PIN_BATTERY_VOLTAGE);
+/**
+ * @brief Generates a complete JSON string with all sections (connection, motor, telemetry).
+ *
+ * Besides the `sensN` values the frame carries "seq", the sequence number of
+ * the last move applied to the motors, used by clients in ack-less mode.
+ * A delta message carries only the channels in `mask` (plus `sens7` and
+ * "seq"); clients keep the previous value of the others. The message is
+ * formatted with `snprintf` into a stack buffer of @ref TELE_JSON_MAX bytes:
+ * if the aggregates do not fit they are left out, the closing brace always is.
+ * @param mask Channels `sens0..sens4` to include.
+ * @param alarm Active alarms, sent as "alarm" when not 0.
+ * @param agg Window aggregates to send as "agg" (channels of "aggMask"), nullptr = none.
+ * @return A JSON string compliant with the custom protocol (including the CMD key).
+ */
+String telemetrySensorString(uint8_t mask, uint8_t alarm, const AggStat *agg)
+{
+  const float ch[TELE_DELTA_CHANNELS] = {imuFrame.Kal[0], -imuFrame.Kal[1], imuFrame.Kal[2], imuFrame.Temperature,
+                                         adcContGetBattery()};
+  char buf[TELE_JSON_MAX];
+  const size_t cap = sizeof(buf) - 2; // posto per le graffe di chiusura di "agg" e del messaggio
+  size_t len = 0;
+  bool ok = telemetryAppend(buf, cap, &len, "{\"CMD\":\"sensor\"%s", mask == TELE_CH_ALL ? "" : ",\"delta\":1");
+  for (uint8_t i = 0; i < TELE_DELTA_CHANNELS; i++)
+    if (mask & (1u << i))
+      ok &= telemetryAppend(buf, cap, &len, ",\"sens%u\":\"%.2f\"", i, ch[i]);
+  ok &= telemetryAppend(buf, cap, &len, "%s,\"sens7\":\"%lu\",\"seq\":%u",
+                        mask == TELE_CH_ALL ? ",\"sens5\":\"0.00\",\"sens6\":\"0.00\"" : "",
+                        (unsigned long)millis(), (unsigned)motorsGetAppliedSeq());
+  if (alarm)
+    ok &= telemetryAppend(buf, cap, &len, ",\"alarm\":%u", alarm);
+  if (agg && teleAggMask && ok)
+  {
+    // "agg":{"n":N,"sensI":[min,max,mean,rms],...}
+    // tutti i canali selezionati hanno lo stesso numero di campioni
+    size_t base = len;
+    bool aggOk = telemetryAppend(buf, cap, &len, ",\"agg\":{\"n\":%lu", (unsigned long)agg[__builtin_ctz(teleAggMask)].n);
+    for (uint8_t i = 0; i < TELE_AGG_CHANNELS && aggOk; i++)
+      if (teleAggMask & (1u << i))
+        aggOk = telemetryAppend(buf, cap, &len, ",\"sens%u\":[%.2f,%.2f,%.2f,%.2f]", i,
+                                agg[i].min, agg[i].max, agg[i].mean, aggStatRms(&agg[i]));
+    if (aggOk)
+      buf[len++] = '}';
+    else
+      len = base; // aggregati troppo lunghi: il messaggio parte senza
+  }
+  if (!ok)
+    DEBUG_PRINTLN("Telemetry: JSON sensor troncato");
+  buf[len++] = '}';
+  buf[len] = '\0';
+  return String(buf);
+}
 
-  if (!imuSuccessful)
+/**
+ * @brief Fills the binary telemetry frame (same channels as `telemetrySensorString()`).
+ *
+ * @param f The frame to fill.
+ */
+void telemetrySensorFrame(WsBinSensor &f)
+{
+  static uint16_t frameSeq = 0;
+  f.hdr.op = WS_BIN_OP_SENSOR;
+  f.hdr.ver = WS_BIN_PROTO_VER;
+  f.hdr.seq = frameSeq++;
+  f.ms = millis();
+  f.angle[0] = telemetryFix16(imuFrame.Kal[0], 100.0f);
+  f.angle[1] = telemetryFix16(-imuFrame.Kal[1], 100.0f);
+  f.angle[2] = telemetryFix16(imuFrame.Kal[2], 100.0f);
+  f.temp = telemetryFix16(imuFrame.Temperature, 100.0f);
+  f.battery = (uint16_t)constrain(lroundf(adcContGetBattery() * 1000.0f), 0L, 65535L);
+  f.aseq = motorsGetAppliedSeq();
+  f.reserved[0] = 0;
+  f.reserved[1] = 0;
+}
+
+/**
+ * @brief Appends the current readings to the history ring.
+ */
+static void telemetryHistoryAdd()
+{
+  if (!teleHistCap)
     return;
+  WsBinHistRec &r = teleHist[teleHistHead];
+  r.ms = millis();
+  r.angle[0] = telemetryFix16(imuFrame.Kal[0], 100.0f);
+  r.angle[1] = telemetryFix16(-imuFrame.Kal[1], 100.0f);
+  r.angle[2] = telemetryFix16(imuFrame.Kal[2], 100.0f);
+  r.temp = telemetryFix16(imuFrame.Temperature, 100.0f);
+  r.battery = (uint16_t)constrain(lroundf(adcContGetBattery() * 1000.0f), 0L, 65535L);
+  teleHistHead = (teleHistHead + 1) % teleHistCap;
+  if (teleHistCount < teleHistCap)
+    teleHistCount++;
+}
 
-  static uint32_t imuTickMs = 0;
-  if ((millis() - imuTickMs) >= 10)
+/**
+ * @brief Size of the history frame with the samples currently in the ring.
+ *
+ * @return The size in bytes, 0 if the history is off or empty.
+ */
+size_t telemetryHistorySize()
+{
+  return teleHistCount ? sizeof(WsBinSensorHist) + (size_t)teleHistCount * sizeof(WsBinHistRec) : 0;
+}
+
+/**
+ * @brief Builds the history frame, oldest sample first.
+ *
+ * @param buf Destination.
+ * @param max Size of `buf`.
+ * @return The frame length in bytes, 0 if there is nothing to send.
+ */
+size_t telemetryHistoryFrame(uint8_t *buf, size_t max)
+{
+  if (!teleHistCount || max < sizeof(WsBinSensorHist) + sizeof(WsBinHistRec))
+    return 0;
+  uint16_t n = teleHistCount;
+  if ((size_t)n > (max - sizeof(WsBinSensorHist)) / sizeof(WsBinHistRec))
+    n = (max - sizeof(WsBinSensorHist)) / sizeof(WsBinHistRec);
+  WsBinSensorHist h;
+  h.hdr.op = WS_BIN_OP_SENSOR_HIST;
+  h.hdr.ver = WS_BIN_PROTO_VER;
+  h.hdr.seq = 0;
+  h.ms = millis();
+  h.count = n;
+  h.recSize = sizeof(WsBinHistRec);
+  h.reserved = 0;
+  memcpy(buf, &h, sizeof(h));
+  // gli n record più recenti, dal più vecchio: al più due copie contigue
+  uint16_t first = (teleHistHead + teleHistCap - n) % teleHistCap;
+  uint16_t tail = (teleHistCap - first < n) ? teleHistCap - first : n;
+  memcpy(buf + sizeof(h), &teleHist[first], (size_t)tail * sizeof(WsBinHistRec));
+  memcpy(buf + sizeof(h) + (size_t)tail * sizeof(WsBinHistRec), teleHist, (size_t)(n - tail) * sizeof(WsBinHistRec));
+  return sizeof(h) + (size_t)n * sizeof(WsBinHistRec);
+}
+
+/**
+ * @brief Fills the binary aggregate frame of the selected channels.
+ *
+ * @param buf Destination, at least `sizeof(WsBinSensorAgg) + TELE_AGG_CHANNELS * sizeof(WsBinAggCh)` bytes.
+ * @param seq Sequence number of the matching @ref WsBinSensor.
+ * @param agg Window aggregates of the channels `sens0..sens3`.
+ * @return The frame length in bytes.
+ */
+static size_t telemetryAggFrame(uint8_t *buf, uint16_t seq, const AggStat *agg)
+{
+  WsBinSensorAgg h;
+  h.hdr.op = WS_BIN_OP_SENSOR_AGG;
+  h.hdr.ver = WS_BIN_PROTO_VER;
+  h.hdr.seq = seq;
+  h.mask = teleAggMask;
+  h.count = 0;
+  size_t len = sizeof(h);
+  uint32_t n = 0;
+  for (uint8_t i = 0; i < TELE_AGG_CHANNELS; i++)
   {
-    IMU.Loop();
-    imuTickMs = millis();
-    imuFrame = IMU.Get_ALL();
+    if (!(teleAggMask & (1u << i)))
+      continue;
+    WsBinAggCh c;
+    c.min = telemetryFix16(agg[i].min, 100.0f);
+    c.max = telemetryFix16(agg[i].max, 100.0f);
+    c.mean = telemetryFix16(agg[i].mean, 100.0f);
+    c.rms = telemetryFix16(aggStatRms(&agg[i]), 100.0f);
+    memcpy(buf + len, &c, sizeof(c));
+    len += sizeof(c);
+    h.count++;
+    n = agg[i].n;
   }
+  h.n = (uint16_t)(n > 65535 ? 65535 : n);
+  memcpy(buf, &h, sizeof(h));
+  return len;
 }
 
-String telemetryAddSensor(uint8_t position, String Value)
+/**
+ * @brief Current channel values in the units of @ref WsBinSensor.
+ *
+ * @param v Output, one value per channel `sens0..sens4`.
+ */
+static void telemetryChannels(int32_t v[TELE_DELTA_CHANNELS])
 {
-  return "\"sens" + String(position) + "\":\"" + Value + "\"";
+  v[0] = telemetryFix16(imuFrame.Kal[0], 100.0f);
+  v[1] = telemetryFix16(-imuFrame.Kal[1], 100.0f);
+  v[2] = telemetryFix16(imuFrame.Kal[2], 100.0f);
+  v[3] = telemetryFix16(imuFrame.Temperature, 100.0f);
+  v[4] = constrain(lroundf(adcContGetBattery() * 1000.0f), 0L, 65535L);
 }
 
 /**
- * @brief Generates a complete JSON string with all sections (connection, motor, telemetry).
- * @return A JSON string compliant with the custom protocol (including the CMD key).
+ * @brief Updates the alarm state from the latest readings.
+ *
+ * An alarm is raised when pitch or roll exceed "alrTilt", or the battery
+ * drops below "alrBatt"; it clears once the reading is back by more than the
+ * channel deadband (hysteresis).
+ * @return The channels whose alarm changed state (to be sent at once), 0 if none.
+ */
+static uint8_t telemetryCheckAlarms()
+{
+  uint8_t alarm = teleAlarm;
+  if (teleAlrTilt)
+  {
+    int32_t pitch = abs(telemetryFix16(imuFrame.Kal[0], 100.0f));
+    int32_t roll = abs(telemetryFix16(imuFrame.Kal[1], 100.0f));
+    int32_t tilt = pitch > roll ? pitch : roll;
+    if (tilt > teleAlrTilt)
+      alarm |= WS_ALARM_TILT;
+    else if (tilt < teleAlrTilt - teleDeadband[0])
+      alarm &= ~WS_ALARM_TILT;
+  }
+  if (teleAlrBatt)
+  {
+    int32_t mv = lroundf(adcContGetBattery() * 1000.0f);
+    if (mv < teleAlrBatt)
+      alarm |= WS_ALARM_BATT;
+    else if (mv > teleAlrBatt + teleDeadband[4])
+      alarm &= ~WS_ALARM_BATT;
+  }
+  uint8_t changed = alarm ^ teleAlarm;
+  teleAlarm = alarm;
+  uint8_t mask = 0;
+  if (changed & WS_ALARM_TILT)
+    mask |= 0x03; // pitch, roll
+  if (changed & WS_ALARM_BATT)
+    mask |= 0x10; // battery
+  return mask;
+}
+
+/**
+ * @brief Updates the period groups from the current "sensor" subscribers.
+ *
+ * A group that still has clients keeps its state; a new group starts with a
+ * keyframe and an empty aggregate window, and is due at once.
+ * @param now Current `millis()`.
+ */
+static void telemetryRatesUpdate(uint32_t now)
+{
+  uint16_t p[WS_MAX_CLIENTS];
+  uint8_t n = websocketTopicPeriods(WS_TOPIC_SENSOR, p, WS_MAX_CLIENTS);
+  bool same = n == teleRateCount;
+  for (uint8_t i = 0; same && i < n; i++)
+    same = teleRates[i].periodMs == p[i];
+  if (same)
+    return;
+  TeleRate old[WS_MAX_CLIENTS];
+  memcpy(old, teleRates, sizeof(old));
+  for (uint8_t i = 0; i < n; i++)
+  {
+    uint8_t j = 0;
+    while (j < teleRateCount && old[j].periodMs != p[i])
+      j++;
+    if (j < teleRateCount)
+    {
+      teleRates[i] = old[j];
+      continue;
+    }
+    TeleRate &r = teleRates[i];
+    r.periodMs = p[i];
+    r.lastMs = now - p[i];
+    r.lastValid = false;
+    for (auto &a : r.agg)
+      aggStatReset(&a);
+  }
+  teleRateCount = n;
+}
+
+/**
+ * @brief Sends the sensor data to the clients of one period group.
+ *
+ * Sends the sensor readings (IMU pitch, roll, yaw, temperature, battery) to
+ * the WebSocket clients subscribed to the "sensor" topic with the period of
+ * the group. Each format (JSON or binary @ref WsBinSensor) is built at most
+ * once and only if some client of the group selected it. The aggregates of
+ * the selected channels travel in the "agg" object of the JSON or in a
+ * @ref WsBinSensorAgg frame, then the window of the group restarts.
+ *
+ * In delta mode ("delta" parameter) only the channels that moved past their
+ * deadband since the last send to the group are transmitted
+ * (@ref WsBinSensorDelta or a JSON with `"delta":1`), and nothing at all if
+ * none did. A full frame is sent every "keyMs", as soon as a client
+ * subscribes and after a delta has been lost in a client queue (replaced by
+ * a newer one before being sent): `r.lastSent` already counts it as sent.
+ *
+ * @param r The period group.
+ * @param v Current channel values (see `telemetryChannels()`).
+ * @param alarmMask Channels to send anyway because an alarm changed state.
+ * @param now Current `millis()`.
  */
-String telemetrySensorString()
+static void broadcastSensors(TeleRate &r, const int32_t v[TELE_DELTA_CHANNELS], uint8_t alarmMask, uint32_t now)
 {
-  uint8_t pos = 0;
-  String jsonString = "{";
-  jsonString += "\"CMD\":\"sensor\",";
+  uint8_t mask = TELE_CH_ALL;
+  if (teleDelta && r.lastValid && now - r.lastKeyMs < teleKeyMs)
+  {
+    mask = alarmMask;
+    for (uint8_t i = 0; i < TELE_DELTA_CHANNELS; i++)
+      if (abs(v[i] - r.lastSent[i]) > teleDeadband[i])
+        mask |= (1u << i);
+    if (!mask)
+      return; // fermo: niente da inviare, la finestra degli aggregati continua
+  }
+  if (mask == TELE_CH_ALL)
+  {
+    r.lastKeyMs = now;
+    r.lastValid = true;
+  }
+  for (uint8_t i = 0; i < TELE_DELTA_CHANNELS; i++)
+    if (mask & (1u << i))
+      r.lastSent[i] = v[i];
+
+  WsBinSensor f;
+  telemetrySensorFrame(f);
 
-  jsonString += telemetryAddSensor(pos++, String(imuFrame.Kal[0]));
-  jsonString += ",";
-  jsonString += telemetryAddSensor(pos++, String((-imuFrame.Kal[1])));
-  jsonString += ",";
-  jsonString += telemetryAddSensor(pos++, String(imuFrame.Kal[2]));
-  jsonString += ",";
-  jsonString += telemetryAddSensor(pos++, String(imuFrame.Temperature));
-  jsonString += ",";
-  jsonString += telemetryAddSensor(pos++, String(batteryVoltage));
-  jsonString += ",";
-  jsonString += telemetryAddSensor(pos++, String(0.0));
-  jsonString += ",";
-  jsonString += telemetryAddSensor(pos++, String(0.0));
-  jsonString += ",";
-  jsonString += telemetryAddSensor(pos++, String(millis()));
-  jsonString += "}";
-  return jsonString;
+  if (websocketHasSubscribers(WS_TOPIC_SENSOR, true, r.periodMs))
+  {
+    if (mask == TELE_CH_ALL && !teleAlarm)
+      websocketPublishBin(WS_TOPIC_SENSOR, &f, sizeof(f), r.periodMs);
+    else
+    {
+      uint8_t d[sizeof(WsBinSensorDelta) + TELE_DELTA_CHANNELS * sizeof(int16_t)];
+      WsBinSensorDelta h;
+      h.hdr = f.hdr;
+      h.hdr.op = WS_BIN_OP_SENSOR_DELTA;
+      h.ms = f.ms;
+      h.mask = mask;
+      h.alarm = teleAlarm;
+      h.aseq = f.aseq;
+      memcpy(d, &h, sizeof(h));
+      size_t len = sizeof(h);
+      for (uint8_t i = 0; i < TELE_DELTA_CHANNELS; i++)
+        if (mask & (1u << i))
+        {
+          uint16_t w = (uint16_t)v[i];
+          memcpy(d + len, &w, sizeof(w));
+          len += sizeof(w);
+        }
+      websocketPublishBin(WS_TOPIC_SENSOR, d, len, r.periodMs, true);
+    }
+    if (teleAggMask)
+    {
+      uint8_t agg[sizeof(WsBinSensorAgg) + TELE_AGG_CHANNELS * sizeof(WsBinAggCh)];
+      size_t len = telemetryAggFrame(agg, f.hdr.seq, r.agg);
+      websocketPublishBin(WS_TOPIC_SENSOR, agg, len, r.periodMs);
+    }
+  }
+  if (websocketHasSubscribers(WS_TOPIC_SENSOR, false, r.periodMs))
+    websocketPublish(WS_TOPIC_SENSOR, telemetrySensorString(mask, teleAlarm, r.agg), r.periodMs, mask != TELE_CH_ALL);
+
+  // nuova finestra di aggregazione
+  for (auto &a : r.agg)
+    aggStatReset(&a);
 }
 
 /**
- * @brief Broadcasts sensor data to connected clients.
+ * @brief Publishes the attitude quaternion on the "attitude" topic.
  *
- * Creates a JSON document with various sensor readings (joystick, motor targets,
- * and IMU data like pitch, roll, and temperature) and broadcasts it to all
- * connected WebSocket clients.
+ * Sends the newest IMU sample, if not already sent, as a @ref WsBinAttitude
+ * to the clients subscribed to the topic (the 3D viewer). In FIFO mode the
+ * quaternion comes straight from the fusion filter; in register mode it is
+ * computed from the Euler angles of the driver.
  */
-static void broadcastSensors()
+static void broadcastAttitude()
 {
-  String s = telemetrySensorString();
-  websocketAsyncMsg(s);
+  static uint16_t frameSeq = 0;
+  static uint32_t lastUs = 0;
+  if (imuQuatUs == lastUs || !websocketHasSubscribers(WS_TOPIC_ATTITUDE, true))
+    return;
+  lastUs = imuQuatUs;
+
+  WsBinAttitude f;
+  f.hdr.op = WS_BIN_OP_ATTITUDE;
+  f.hdr.ver = WS_BIN_PROTO_VER;
+  f.hdr.seq = frameSeq++;
+  f.tUs = imuQuatUs;
+  if (imuQuat[0] | imuQuat[1] | imuQuat[2] | imuQuat[3])
+    memcpy(f.q, imuQuat, sizeof(f.q));
+  else
+  {
+    int32_t q[4];
+    fxEulerQuat(imuFrame.Kal[0], imuFrame.Kal[1], imuFrame.Kal[2], q);
+    for (int k = 0; k < 4; k++)
+      f.q[k] = (int16_t)((q[k] + (1 << 15)) >> 16);
+  }
+  websocketPublishBin(WS_TOPIC_ATTITUDE, &f, sizeof(f));
 }
 
 /**
  * @brief The main telemetry update loop.
  *
- * This function calls `imuLoop()` to update the IMU data. It also checks if the
- * sensor broadcast period has elapsed and calls `broadcastSensors()` to send
- * the latest data.
+ * This function calls `imuLoop()` to update the IMU data. Then, for each
+ * period group of the "sensor" subscribers (see @ref TeleRate), it checks if
+ * the period of the group has elapsed and calls `broadcastSensors()` to send
+ * the latest data; an alarm that changes state is sent immediately, out of
+ * period. All the groups read the same snapshot of the channels. The attitude
+ * quaternion has its own, faster period ("attHz").
  */
 void telemetryTick()
 {
 
-  static uint32_t lastSensorMs = 0;
+  static uint32_t lastHistMs = 0;
+
+  // re-init prima del test su enable, altrimenti abilitare la telemetria non avrebbe effetto
+  if (imuReinit)
+  {
+    telemetryInit();
+    return;
+  }
+  telemetryApplyPending();
 
   if (EnableTelemetry == 0)
     return;
 
   // aggiorna imu
   imuLoop();
-  // telemetria periodica
+  // telemetria periodica, subito se un allarme cambia stato
+  uint8_t alarmMask = telemetryCheckAlarms();
   uint32_t now = millis();
-  if (now - lastSensorMs >= SENSOR_PERIOD_MS)
+  if (now - lastHistMs >= SENSOR_PERIOD_MS)
+  {
+    lastHistMs = now;
+    telemetryHistoryAdd(); // lo storico ha il periodo di default, anche senza invii
+  }
+  // un gruppo per periodo dei client, tutti dallo stesso campione
+  telemetryRatesUpdate(now);
+  if (websocketTakeNewSubscribers(WS_TOPIC_SENSOR))
+    for (uint8_t g = 0; g < teleRateCount; g++)
+      teleRates[g].lastValid = false; // keyframe per il nuovo client o dopo un delta perso
+  int32_t v[TELE_DELTA_CHANNELS];
+  bool haveV = false;
+  for (uint8_t g = 0; g < teleRateCount; g++)
+  {
+    TeleRate &r = teleRates[g];
+    if (!alarmMask && now - r.lastMs < r.periodMs)
+      continue;
+    r.lastMs = now;
+    if (!haveV)
+    {
+      telemetryChannels(v);
+      haveV = true;
+    }
+    broadcastSensors(r, v, alarmMask, now);
+  }
+  // quaternione per il visualizzatore 3D
+  static uint32_t lastAttMs = 0;
+  if (teleAttMs && now - lastAttMs >= teleAttMs)
   {
-    lastSensorMs = now;
-    broadcastSensors();
+    lastAttMs = now;
+    broadcastAttitude();
   }
 }
@@ -42,13 +42,28 @@
  */
 typedef void (*WsCommandHandler)(AsyncWebSocketClient *, JsonDocument &);
 
+/**
+ * @enum WsAckMode
+ * @brief How `move` commands are acknowledged to a client.
+ *
+ * Selected by the client with the optional "ack" field of `hello_robora`.
+ */
+enum WsAckMode : uint8_t
+{
+  WS_ACK_EACH = 0, ///< Every `move` gets its own JSON reply (default, legacy behaviour).
+  WS_ACK_NONE,     ///< No reply to `move`.
+  WS_ACK_TELE,     ///< No reply; the last applied sequence travels in the telemetry frame as "seq".
+};
+
 /*-- Function declarations (forward declaration) --*/
 static void onWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len);
 static void ws_connect_hello(AsyncWebSocketClient *client);
 static void handleWsMessage(AsyncWebSocketClient *client, const char *payload, size_t len);
 static void handleWsBinary(AsyncWebSocketClient *client, const uint8_t *payload, size_t len);
 static void WsSendJson(AsyncWebSocketClient *client, const JsonDocument &doc);
-static void ws_cmd_error(AsyncWebSocketClient *client, String Errortype);
+static void ws_cmd_error(AsyncWebSocketClient *client, const char *Errortype);
+static struct sWsAcc *WsGetAcc(uint32_t id);
+static ArduinoJson::Allocator *WsArena(AsyncWebSocketClient *client);
 
 /*-- Command handler declarations --*/
 static void ws_cmd_hello(AsyncWebSocketClient *client, JsonDocument &doc);
@@ -61,52 +76,11 @@ static void ws_cmd_move(AsyncWebSocketClient *client, JsonDocument &doc);
 static void ws_cmd_function(AsyncWebSocketClient *client, JsonDocument &doc);
 static void ws_cmd_reset_memory(AsyncWebSocketClient *client, JsonDocument &doc);
 static void ws_cmd_sendString(AsyncWebSocketClient *client, JsonDocument &doc);
-
-/**
- * @brief FifoStringDyn object instance for Fifo String.
- */
-FifoStringDyn Fsd;
-
-/**
- * @brief Secure load queue message for sending via web server .
- *
- * This function queues messages to be sent asynchronously
- * but in a controlled manner through the web server.
- * @param msg The message push.
- * @return The boolean value of correct push.
- */
-bool websocketAsyncMsg(const String &msg)
-{
-  uint8_t idClient;
-  bool RET = false;
-  if (websocketAreClients())
-    RET = Fsd.push(msg);
-  return RET;
-}
-
-/**
- * @brief Secure pop queue message sending via web server .
- *
- * This function sends messages to the web server is present
- * in the queue
- * @param AreClient client presence
- * @return The current number of elements in the queue
- */
-size_t websocketSendAsyncMsg(bool AreClient)
-{
-  String s;
-  if (AreClient) // client
-  {
-    if (!Fsd.isEmpty()) // message
-    {
-      if (Fsd.pop(s)) // extract mesg
-      {
-        ws.textAll(s); // send
-      }
-    }
-  }
-  return Fsd.size();
-}
+static void ws_cmd_ping(AsyncWebSocketClient *client, JsonDocument &doc);
+static void ws_cmd_sub(AsyncWebSocketClient *client, JsonDocument &doc);
+static void ws_cmd_unsub(AsyncWebSocketClient *client, JsonDocument &doc);
+static void ws_cmd_blackbox(AsyncWebSocketClient *client, JsonDocument &doc);
+static void ws_cmd_sync(AsyncWebSocketClient *client, JsonDocument &doc);
 
 /*-- Helper for safe parameter extraction --*/
 /**
@@ -186,16 +160,42 @@ uint16_t ws_getU16(const JsonVariant &v, uint16_t def)
  * @brief Represents a WebSocket connection accumulator.
  *
  * This structure is used to accumulate data frames for a single WebSocket
- * message, which may be fragmented across multiple frames. It stores the
- * state and buffer for a specific client connection.
+ * message, which may be fragmented across multiple frames or TCP chunks. It
+ * stores the state and a fixed slab for a specific client connection, together
+ * with the per-client session settings that live as long as the connection.
+ * All the buffers are preallocated, so the RAM used by the pool is
+ * `sizeof(s_acc)`, known at compile time.
  */
 typedef struct sWsAcc
 {
   uint32_t id = 0;          ///< @brief The unique identifier for the WebSocket connection.
   bool inUse = false;       ///< @brief Flag to indicate if this accumulator slot is currently in use.
   uint8_t firstOpcode = 0;  ///< @brief The opcode of the first frame (TEXT or BINARY) of the message.
-  size_t expectedLen = 0;   ///< @brief The total expected length of the complete message.
-  std::vector<uint8_t> buf; ///< @brief A byte-precise buffer to accumulate the message data.
+  size_t expectedLen = 0;   ///< @brief The length announced by the first frame of the message.
+  size_t slabLen = 0;       ///< @brief Number of bytes accumulated in @ref slab.
+  uint8_t slab[WS_MAX_PAYLOAD]; ///< @brief Fixed buffer to accumulate a fragmented message.
+  uint8_t ackMode = WS_ACK_EACH; ///< @brief How `move` commands are acknowledged (@ref WsAckMode).
+  bool seqValid = false;    ///< @brief True once a sequenced move has been accepted.
+  uint16_t lastSeq = 0;     ///< @brief Sequence number of the last accepted move.
+  int64_t rxUs = 0;         ///< @brief Time (us) of the first chunk of the message being handled.
+  LatHist rtt;              ///< @brief Round trip times reported by the client in its pings.
+  ClockSync clk;            ///< @brief Offset/drift estimate of the client clock.
+  int64_t syncT[3] = {};    ///< @brief t1, t2, t3 of the last sync, closed by the next request.
+  uint8_t subMask = WS_TOPIC_ALL_MASK;    ///< @brief Subscribed topics, bit `1 << WsTopic`.
+  uint8_t binMask = 0;                    ///< @brief Topics received in binary format (subset of @ref WS_TOPIC_BIN_MASK).
+  uint16_t subMinMs[WS_TOPIC_COUNT] = {}; ///< @brief Minimum interval between two messages of a topic (0 = no limit).
+  uint32_t subLastMs[WS_TOPIC_COUNT] = {}; ///< @brief `millis()` of the last message of a topic sent to the client.
+  bool histPending = false;               ///< @brief The telemetry history has to be sent (binary "sensor" just subscribed).
+  alignas(8) uint8_t arenaMem[WS_JSON_ARENA_SIZE]; ///< @brief Preallocated memory of the JSON arena.
+  JsonArena arena{arenaMem, sizeof(arenaMem)};     ///< @brief JSON arena, reset after every message.
+  WsOutMsg outCtrl[WS_OUTQ_CTRL_DEPTH];   ///< @brief Slots of the control (ack) queue.
+  WsOutMsg outEvent[WS_OUTQ_EVENT_DEPTH]; ///< @brief Slots of the event (OTA, async messages) queue.
+  WsOutMsg outTele[WS_OUTQ_TELE_DEPTH];   ///< @brief Telemetry slots, at most one (the newest) frame per kind.
+  WsOutRing out[WS_PRIO_COUNT] = {{outCtrl, WS_OUTQ_CTRL_DEPTH, 0, 0},
+                                  {outEvent, WS_OUTQ_EVENT_DEPTH, 0, 0},
+                                  {outTele, WS_OUTQ_TELE_DEPTH, 0, 0}}; ///< @brief Outbound queues, indexed by @ref WsPrio.
+  uint32_t outDropped = 0;   ///< @brief Messages dropped because a queue was full.
+  uint32_t outCoalesced = 0; ///< @brief Telemetry frames replaced by a newer one before being sent.
 } WsAcc;
 
 /**
@@ -208,38 +208,555 @@ typedef struct sWsAcc
 static WsAcc s_acc[WS_MAX_CLIENTS];
 
 /**
- * @brief Map of WebSocket commands.
+ * @brief Spinlock protecting the outbound queues of @ref s_acc.
+ *
+ * Messages are queued from the AsyncTCP task (acks, OTA) and from the main
+ * loop (telemetry), and drained by the main loop.
+ */
+static portMUX_TYPE s_outMux = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Default period (ms) of the paced topics, 0 = not paced.
+ *
+ * A paced topic is published per period group: every client gets it at its
+ * own rate ("hz" of the "sub" command), or at this period if it did not ask.
+ * Set by the producer (see `websocketSetTopicPeriod()`).
+ */
+static uint16_t s_topicPeriodMs[WS_TOPIC_COUNT] = {};
+
+/**
+ * @brief Topics with a subscriber that has not received a full message yet.
+ *
+ * Set when a client connects or (re)subscribes, or when a delta frame is
+ * replaced or dropped in its queue; consumed by the producers that send
+ * deltas (see `websocketTakeNewSubscribers()`). Protected by @ref s_outMux.
+ */
+static uint8_t s_freshTopics = 0;
+
+/**
+ * @brief Marks topics as having a new subscriber.
+ * @param mask Topics, bit `1 << WsTopic`.
+ */
+static void WsMarkFresh(uint8_t mask)
+{
+  portENTER_CRITICAL(&s_outMux);
+  s_freshTopics |= mask;
+  portEXIT_CRITICAL(&s_outMux);
+}
+
+/**
+ * @brief Empties all the outbound queues of a client slot.
+ * @param a The client slot.
+ */
+static void WsOutClear(WsAcc *a)
+{
+  portENTER_CRITICAL(&s_outMux);
+  for (auto &r : a->out)
+    wsOutQClear(&r);
+  a->outDropped = 0;
+  a->outCoalesced = 0;
+  portEXIT_CRITICAL(&s_outMux);
+}
+
+/**
+ * @brief Queues a message on a client slot.
+ *
+ * A full control or event queue drops its oldest message. In the telemetry
+ * queue a new frame replaces the one of the same kind still waiting, so a
+ * slow client gets the newest sensor frame and the newest attitude frame
+ * instead of one evicting the other. A lost delta frame marks its topic so
+ * that the producer sends a full frame next (see `wsOutQPush()`).
+ *
+ * @param a The client slot.
+ * @param prio The priority class.
+ * @param data The message bytes.
+ * @param len The message length, at most @ref WS_OUTQ_SLOT_SIZE.
+ * @param binary True for a binary frame.
+ * @param key Kind of telemetry frame, ignored for the other classes.
+ * @param resync Topics to resync if the message is lost (delta frames), 0 = none.
+ */
+static void WsOutPush(WsAcc *a, WsPrio prio, const void *data, size_t len, bool binary, uint8_t key, uint8_t resync)
+{
+  uint8_t lost;
+  portENTER_CRITICAL(&s_outMux);
+  if (!wsOutQPush(&a->out[prio], data, len, binary, key, resync, prio == WS_PRIO_TELEMETRY, &lost))
+  {
+    if (prio == WS_PRIO_TELEMETRY)
+      a->outCoalesced++;
+    else
+      a->outDropped++;
+    s_freshTopics |= lost; // il client ha perso un delta: al prossimo giro un frame completo
+  }
+  portEXIT_CRITICAL(&s_outMux);
+}
+
+/**
+ * @brief Extracts the next message to send, highest priority first.
+ * @param a The client slot.
+ * @param out Where the message is copied.
+ * @return false if all the queues of the slot are empty.
+ */
+static bool WsOutPop(WsAcc *a, WsOutMsg &out)
+{
+  bool found = false;
+  portENTER_CRITICAL(&s_outMux);
+  for (auto &r : a->out)
+    if ((found = wsOutQPop(&r, &out)))
+      break;
+  portEXIT_CRITICAL(&s_outMux);
+  return found;
+}
+
+/**
+ * @brief Sends a message to a client or queues it if the client is busy.
+ *
+ * Control messages go out immediately when the client queue of AsyncTCP has
+ * room and nothing of the same class is waiting; everything else is queued
+ * and drained by `websocketTick()`. Messages that do not fit a slot are sent
+ * immediately, or dropped if the client cannot accept them.
+ *
+ * @param a The client slot.
+ * @param client The client, may be null if not known by the caller.
+ * @param prio The priority class.
+ * @param data The message bytes.
+ * @param len The message length.
+ * @param binary True for a binary frame.
+ * @param key Kind of telemetry frame (see `WsOutPush()`).
+ * @param resync Topics to resync if the message is lost (delta frames), 0 = none.
+ */
+static void WsOutSend(WsAcc *a, AsyncWebSocketClient *client, WsPrio prio, const void *data, size_t len, bool binary, uint8_t key = 0,
+                      uint8_t resync = 0)
+{
+  if (!client)
+    client = ws.client(a->id);
+  if (!client)
+    return;
+
+  bool direct = (len > WS_OUTQ_SLOT_SIZE) || (prio == WS_PRIO_CONTROL && a->out[WS_PRIO_CONTROL].count == 0);
+  if (direct)
+  {
+    if (client->canSend())
+    {
+      if (binary)
+        client->binary((const uint8_t *)data, len);
+      else
+        client->text((const char *)data, len);
+      return;
+    }
+    if (len > WS_OUTQ_SLOT_SIZE)
+    {
+      portENTER_CRITICAL(&s_outMux);
+      a->outDropped++;
+      s_freshTopics |= resync;
+      portEXIT_CRITICAL(&s_outMux);
+      return;
+    }
+  }
+  WsOutPush(a, prio, data, len, binary, key, resync);
+}
+
+/**
+ * @brief Sends the queued messages of every client as long as its link allows.
+ *
+ * For each client, messages are sent highest priority first while AsyncTCP
+ * reports room in the client queue (`canSend()`), up to @ref WS_OUTQ_BURST per
+ * call. A slow client keeps its messages queued without delaying the others.
+ */
+static void WsOutDrain()
+{
+  static WsOutMsg m;
+  for (auto &a : s_acc)
+  {
+    if (!a.inUse)
+      continue;
+    AsyncWebSocketClient *client = ws.client(a.id);
+    if (!client)
+      continue;
+    for (uint8_t n = 0; n < WS_OUTQ_BURST && client->canSend(); n++)
+    {
+      if (!WsOutPop(&a, m))
+        break;
+      if (m.binary)
+        client->binary((const uint8_t *)m.data, m.len);
+      else
+        client->text(m.data, m.len);
+    }
+  }
+}
+
+/**
+ * @brief Sends the telemetry history to the clients that just subscribed.
+ *
+ * The frame (@ref WsBinSensorHist) can be larger than a queue slot, so it is
+ * built on the heap and handed to AsyncTCP directly, once the client has room
+ * in its queue. Runs in the loop task, like `telemetryTick()` that fills the
+ * history ring.
+ */
+static void WsHistDrain()
+{
+  for (auto &a : s_acc)
+  {
+    if (!a.inUse || !a.histPending)
+      continue;
+    AsyncWebSocketClient *client = ws.client(a.id);
+    if (!client)
+      continue;
+    if (!client->canSend())
+      continue; // riprova al prossimo giro
+    a.histPending = false;
+    size_t size = telemetryHistorySize();
+    if (!size)
+      continue;
+    uint8_t *buf = (uint8_t *)malloc(size);
+    if (!buf)
+      continue;
+    size_t len = telemetryHistoryFrame(buf, size);
+    if (len)
+      client->binary(buf, len);
+    free(buf);
+  }
+}
+
+/**
+ * @brief Secure load queue message for sending via web server .
+ *
+ * This function queues the message on the outbound queue of every
+ * connected client, with the given priority.
+ * @param msg The message push.
+ * @param prio The priority class of the message.
+ * @return The boolean value of correct push.
+ */
+bool websocketAsyncMsg(const String &msg, WsPrio prio)
+{
+  bool RET = false;
+  for (auto &a : s_acc)
+  {
+    if (!a.inUse)
+      continue;
+    WsOutSend(&a, nullptr, prio, msg.c_str(), msg.length(), false);
+    RET = true;
+  }
+  return RET;
+}
+
+/**
+ * @brief Names of the topics, indexed by @ref WsTopic.
+ */
+static const char *const ws_topic_names[WS_TOPIC_COUNT] = {"sensor", "ota", "display", "log", "attitude"};
+
+/**
+ * @brief Period of a paced topic for a client.
+ *
+ * @param a The client slot.
+ * @param topic The topic.
+ * @return The period asked by the client, or the default one of the topic.
+ */
+static uint16_t WsClientPeriod(const WsAcc &a, WsTopic topic)
+{
+  return a.subMinMs[topic] ? a.subMinMs[topic] : s_topicPeriodMs[topic];
+}
+
+/**
+ * @brief Queues a message for the subscribers of a topic in one format.
+ *
+ * @param topic The topic of the message.
+ * @param data The message bytes.
+ * @param len Length of the message.
+ * @param binary true for the binary subscribers (binary frame), false for the JSON ones (text frame).
+ * @param periodMs Only the clients with this period (paced topics), 0 = every subscriber.
+ * @param delta True for a delta frame: if a client loses it, the topic asks for a full frame.
+ * @return true if at least one client got the message.
+ */
+static bool WsPublish(WsTopic topic, const void *data, size_t len, bool binary, uint16_t periodMs, bool delta)
+{
+  if (topic >= WS_TOPIC_COUNT)
+    return false;
+  WsPrio prio = (topic == WS_TOPIC_SENSOR || topic == WS_TOPIC_ATTITUDE) ? WS_PRIO_TELEMETRY : WS_PRIO_EVENT;
+  uint32_t now = millis();
+  bool RET = false;
+  for (auto &a : s_acc)
+  {
+    if (!a.inUse || !(a.subMask & (1u << topic)) || (bool)(a.binMask & (1u << topic)) != binary)
+      continue;
+    if (periodMs)
+    {
+      if (WsClientPeriod(a, topic) != periodMs)
+        continue; // altro gruppo di periodo
+    }
+    else if (a.subMinMs[topic] && (now - a.subLastMs[topic]) < a.subMinMs[topic])
+      continue; // rate limit del client
+    a.subLastMs[topic] = now;
+    // tipo di frame: l'opcode per i binari, il topic per il JSON
+    WsOutSend(&a, nullptr, prio, data, len, binary, binary ? ((const uint8_t *)data)[0] : (uint8_t)topic,
+              delta ? (uint8_t)(1u << topic) : 0);
+    RET = true;
+  }
+  return RET;
+}
+
+/**
+ * @brief Queues a message for the subscribers of a topic.
+ *
+ * @param topic The topic of the message.
+ * @param msg The message to publish.
+ * @param periodMs Only the clients with this period (paced topics), 0 = every subscriber.
+ * @param delta True for a delta message.
+ * @return true if at least one client got the message.
+ */
+bool websocketPublish(WsTopic topic, const String &msg, uint16_t periodMs, bool delta)
+{
+  return WsPublish(topic, msg.c_str(), msg.length(), false, periodMs, delta);
+}
+
+/**
+ * @brief Queues a binary frame for the subscribers of a topic.
+ *
+ * @param topic The topic of the frame.
+ * @param data The frame bytes.
+ * @param len Length of the frame.
+ * @param periodMs Only the clients with this period (paced topics), 0 = every subscriber.
+ * @param delta True for a delta frame.
+ * @return true if at least one client got the frame.
+ */
+bool websocketPublishBin(WsTopic topic, const void *data, size_t len, uint16_t periodMs, bool delta)
+{
+  return WsPublish(topic, data, len, true, periodMs, delta);
+}
+
+/**
+ * @brief Checks if any connected client is subscribed to a topic in a format.
+ *
+ * @param topic The topic to check.
+ * @param binary true to check the binary format, false for JSON.
+ * @param periodMs Only the clients with this period (paced topics), 0 = any.
+ * @return true if at least one client is subscribed.
+ */
+bool websocketHasSubscribers(WsTopic topic, bool binary, uint16_t periodMs)
+{
+  for (auto &a : s_acc)
+    if (a.inUse && (a.subMask & (1u << topic)) && (bool)(a.binMask & (1u << topic)) == binary &&
+        (!periodMs || WsClientPeriod(a, topic) == periodMs))
+      return true;
+  return false;
+}
+
+/**
+ * @brief Makes a topic paced, with a default period.
+ *
+ * @param topic The topic.
+ * @param defMs Period of the clients that did not ask for a rate, 0 = not paced.
+ */
+void websocketSetTopicPeriod(WsTopic topic, uint16_t defMs)
+{
+  if (topic < WS_TOPIC_COUNT)
+    s_topicPeriodMs[topic] = defMs;
+}
+
+/**
+ * @brief Lists the distinct periods of the subscribers of a paced topic.
+ *
+ * @param topic The topic.
+ * @param periods Output, one entry per distinct period.
+ * @param max Size of @p periods.
+ * @return The number of distinct periods.
+ */
+uint8_t websocketTopicPeriods(WsTopic topic, uint16_t *periods, uint8_t max)
+{
+  uint8_t n = 0;
+  if (topic >= WS_TOPIC_COUNT)
+    return 0;
+  for (auto &a : s_acc)
+  {
+    if (!a.inUse || !(a.subMask & (1u << topic)))
+      continue;
+    uint16_t p = WsClientPeriod(a, topic);
+    uint8_t i = 0;
+    while (i < n && periods[i] != p)
+      i++;
+    if (i == n && n < max)
+      periods[n++] = p;
+  }
+  return n;
+}
+
+/**
+ * @brief Checks and clears the "new subscriber" flag of a topic.
+ *
+ * @param topic The topic.
+ * @return true if a client subscribed (or connected), or lost a delta frame, since the last call.
+ */
+bool websocketTakeNewSubscribers(WsTopic topic)
+{
+  portENTER_CRITICAL(&s_outMux);
+  bool fresh = s_freshTopics & (1u << topic);
+  s_freshTopics &= ~(1u << topic);
+  portEXIT_CRITICAL(&s_outMux);
+  return fresh;
+}
+
+/**
+ * @brief Publishes a log line on the @ref WS_TOPIC_LOG topic.
+ *
+ * @param text The log line.
+ */
+void websocketLog(const String &text)
+{
+  if (!websocketHasSubscribers(WS_TOPIC_LOG))
+    return;
+  JsonDocument doc;
+  doc["CMD"] = "log";
+  doc["msg"] = text;
+  String s;
+  serializeJson(doc, s);
+  websocketPublish(WS_TOPIC_LOG, s);
+}
+
+/**
+ * @brief Publishes a "key=value" log line without touching the heap.
+ *
+ * Same message as `websocketLog()`, built only if someone is subscribed to
+ * the log, with the line and the JSON on the stack and the document in the
+ * arena of the client that triggered it. Used on the hot paths (a dragged
+ * config slider sends a stream of `config_wr`).
+ *
+ * @param client The client that triggered the log line.
+ * @param prefix Prefix of the line (e.g. "config").
+ * @param key The key.
+ * @param val The value.
+ */
+static void WsLogKeyVal(AsyncWebSocketClient *client, const char *prefix, const char *key, const char *val)
+{
+  if (!websocketHasSubscribers(WS_TOPIC_LOG))
+    return;
+  char line[CONFIG_STRING_LEN + 32];
+  snprintf(line, sizeof(line), "%s %s=%s", prefix, key, val);
+  JsonDocument doc(WsArena(client));
+  doc["CMD"] = "log";
+  doc["msg"] = line;
+  char out[WS_OUTQ_SLOT_SIZE];
+  if (measureJson(doc) >= sizeof(out))
+    return;
+  size_t n = serializeJson(doc, out, sizeof(out));
+  WsPublish(WS_TOPIC_LOG, out, n, false, 0, false);
+}
+
+/**
+ * @brief Checks a move sequence number against the last one accepted from the client.
+ *
+ * Sequence numbers wrap at 65535, so the comparison is done on the signed
+ * 16-bit difference. A move that is not newer than the last accepted one is
+ * stale and must be dropped.
+ *
+ * @param acc The client slot (if null the move is always accepted).
+ * @param seq The sequence number of the received move.
+ * @return true if the move is newer and must be applied, false if it is stale.
+ */
+static bool WsAcceptSeq(WsAcc *acc, uint16_t seq)
+{
+  if (!acc)
+    return true;
+  if (acc->seqValid && (int16_t)(seq - acc->lastSeq) <= 0)
+    return false;
+  acc->lastSeq = seq;
+  acc->seqValid = true;
+  return true;
+}
+
+/**
+ * @brief List of WebSocket commands.
+ *
+ * Associates a command string and its integer ID with a function pointer.
+ * It is a constant array, so it lives in flash and needs no heap.
+ */
+static constexpr WsCmdEntry<WsCommandHandler> ws_command_list[] = {
+    {"hello_robora", WS_CMD_HELLO, WS_CMD_F_NOARGS, ws_cmd_hello},
+    {"reboot", WS_CMD_REBOOT, WS_CMD_F_NOARGS, ws_cmd_reboot},
+    {"config_req", WS_CMD_CONFIG_REQ, WS_CMD_F_NOARGS, ws_cmd_config_req},
+    {"config_rd", WS_CMD_CONFIG_RD, WS_CMD_F_NONE, ws_cmd_config_rd},
+    {"config_wr", WS_CMD_CONFIG_WR, WS_CMD_F_NONE, ws_cmd_config_wr},
+    {"info_req", WS_CMD_INFO_REQ, WS_CMD_F_NOARGS, ws_cmd_sendInfo},
+    {"move", WS_CMD_MOVE, WS_CMD_F_NONE, ws_cmd_move},
+    {"function", WS_CMD_FUNCTION, WS_CMD_F_NONE, ws_cmd_function},
+    {"reset_memory", WS_CMD_RESET_MEMORY, WS_CMD_F_NOARGS, ws_cmd_reset_memory},
+    {"displaymsg", WS_CMD_DISPLAYMSG, WS_CMD_F_NONE, ws_cmd_sendString},
+    {"ping", WS_CMD_PING, WS_CMD_F_NONE, ws_cmd_ping},
+    {"sub", WS_CMD_SUB, WS_CMD_F_NONE, ws_cmd_sub},
+    {"unsub", WS_CMD_UNSUB, WS_CMD_F_NONE, ws_cmd_unsub},
+    {"blackbox", WS_CMD_BLACKBOX, WS_CMD_F_NONE, ws_cmd_blackbox},
+    {"sync", WS_CMD_SYNC, WS_CMD_F_NONE, ws_cmd_sync}};
+
+/**
+ * @brief Perfect-hash dispatch table of the WebSocket commands.
  *
- * A static map that associates a command string (key) with a function pointer
- * (value). This approach allows for efficient dispatching of received commands.
+ * Built at compile time from @ref ws_command_list: lookup by name is one hash
+ * and one `strcmp`, lookup by ID is an array access.
  */
-static std::map<String, WsCommandHandler> ws_commands = {
-    {"hello_robora", ws_cmd_hello},
-    {"reboot", ws_cmd_reboot},
-    {"config_req", ws_cmd_config_req},
-    {"config_rd", ws_cmd_config_rd},
-    {"config_wr", ws_cmd_config_wr},
-    {"info_req", ws_cmd_sendInfo},
-    {"move", ws_cmd_move},
-    {"function", ws_cmd_function},
-    {"reset_memory", ws_cmd_reset_memory},
-    {"displaymsg", ws_cmd_sendString}};
+static constexpr auto ws_commands = wsCmdMakeTable<32>(ws_command_list);
+static_assert(ws_commands.perfect, "no collision free seed for ws_commands, increase the bucket count");
+
+/**
+ * @brief Reusable serialization buffer of `WsSendJson()`.
+ *
+ * Only used from the AsyncTCP task, where all the WebSocket events run.
+ */
+static char s_txBuf[WS_JSON_TX_SIZE];
+
+/**
+ * @brief Returns the JSON allocator of a client.
+ *
+ * Documents built while handling a message of the client take their memory
+ * from its preallocated arena; without a slot the counting heap allocator is
+ * used.
+ *
+ * @param client Pointer to the client.
+ * @return The allocator to pass to the `JsonDocument` constructor.
+ */
+static ArduinoJson::Allocator *WsArena(AsyncWebSocketClient *client)
+{
+  WsAcc *acc = client ? WsGetAcc(client->id()) : nullptr;
+  if (acc)
+    return &acc->arena;
+  return JsonHeapAllocator::instance();
+}
 
 /**
  * @brief Sends a JSON document to a client or broadcasts it.
  *
- * Serializes a JSON document into a string and sends it to the specified client.
+ * Serializes a JSON document into the reusable buffer and sends it to the specified client
+ * with control priority (see `WsOutSend()`).
  * If the client pointer is null, the message is broadcast to all connected clients.
+ * Documents larger than the buffer are serialized into a temporary String.
  *
  * @param client Pointer to the destination client. If null, the message is broadcast.
  * @param doc Reference to the JSON document to be sent.
  */
 static void WsSendJson(AsyncWebSocketClient *client, const JsonDocument &doc)
 {
-  String s;
-  if (serializeJson(doc, s) == 0)
+  size_t n = measureJson(doc);
+  if (n == 0)
     return;
 
+  if (n < sizeof(s_txBuf))
+  {
+    serializeJson(doc, s_txBuf, sizeof(s_txBuf));
+    if (client) // single client
+    {
+      if (WsAcc *acc = WsGetAcc(client->id()))
+        WsOutSend(acc, client, WS_PRIO_CONTROL, s_txBuf, n, false);
+      else
+        client->text(s_txBuf, n);
+    }
+    else // brodcast
+    {
+      for (auto &a : s_acc)
+        if (a.inUse)
+          WsOutSend(&a, nullptr, WS_PRIO_CONTROL, s_txBuf, n, false);
+    }
+    return;
+  }
+
+  String s;
+  serializeJson(doc, s);
   if (client) // single client
     client->text(s);
   else // brodcast
@@ -256,10 +773,11 @@ static void WsSendJson(AsyncWebSocketClient *client, const JsonDocument &doc)
  */
 static void ws_connect_hello(AsyncWebSocketClient *client)
 {
-  JsonDocument ack;
+  JsonDocument ack(WsArena(client));
   ack["CMD"] = "hello_webui";
   ack["server"] = CONNECTION_HOSTNAME;
   ack["ver"] = VERSIONE_APP;
+  ack["bin"] = WS_BIN_PROTO_VER;
   WsSendJson(client, ack);
 }
 
@@ -267,7 +785,7 @@ static void ws_connect_hello(AsyncWebSocketClient *client)
  * @brief Handles a received WebSocket message TEXT.
  *
  * This function deserializes the JSON message payload, extracts the command,
- * and looks it up in the `ws_commands` map. If the command is found, it calls
+ * and looks it up in the `ws_commands` table. If the command is found, it calls
  * the associated handler function. Otherwise, it sends an error message.
  *
  * @param client Pointer to the client that sent the message.
@@ -276,23 +794,24 @@ static void ws_connect_hello(AsyncWebSocketClient *client)
  */
 static void handleWsMessage(AsyncWebSocketClient *client, const char *payload, size_t len)
 {
-  JsonDocument doc;
+  JsonDocument doc(WsArena(client));
   DeserializationError err = deserializeJson(doc, payload, len);
   if (err)
   {
-    JsonDocument error_doc;
+    JsonDocument error_doc(WsArena(client));
     error_doc["CMD"] = "error";
-    error_doc["msg"] = "invalid json payload" + String(err.c_str());
+    error_doc["msg"] = "invalid json payload";
+    error_doc["err"] = err.c_str();
     WsSendJson(client, error_doc);
     return;
   }
 
   const char *cmd = doc["CMD"] | "";
 
-  auto it = ws_commands.find(cmd);
-  if (it != ws_commands.end())
+  const WsCmdEntry<WsCommandHandler> *e = ws_commands.find(cmd);
+  if (e)
   {
-    it->second(client, doc);
+    e->handler(client, doc);
   }
   else
   {
@@ -300,33 +819,229 @@ static void handleWsMessage(AsyncWebSocketClient *client, const char *payload, s
   }
 }
 
+/**
+ * @brief Sends a binary acknowledge for a received binary frame.
+ *
+ * @param client Pointer to the destination client.
+ * @param hdr Header of the acknowledged frame.
+ * @param status The `WS_BIN_ACK_*` status.
+ */
+static void WsSendBinAck(AsyncWebSocketClient *client, const WsBinHdr &hdr, uint8_t status)
+{
+  WsBinAck ack;
+  ack.hdr.op = WS_BIN_OP_ACK;
+  ack.hdr.ver = WS_BIN_PROTO_VER;
+  ack.hdr.seq = hdr.seq;
+  ack.reqOp = hdr.op;
+  ack.status = status;
+  client->binary((const uint8_t *)&ack, sizeof(ack));
+}
+
+/**
+ * @brief Records the RTT reported by a client and fills a pong.
+ *
+ * The pong carries the receive and dispatch timestamps of the ping and the
+ * timing of the last setpoint applied by the motor control task, so the client
+ * can split the joystick-to-motor delay into network, firmware dispatch and
+ * wait for the control period.
+ *
+ * @param client Pointer to the client that sent the ping.
+ * @param t Client timestamp of the ping.
+ * @param rtt RTT of the previous ping measured by the client, in us (0 = none).
+ * @param pong The pong to fill (the header is left to the caller).
+ */
+static void WsPingPong(AsyncWebSocketClient *client, uint32_t t, uint32_t rtt, WsBinPong &pong)
+{
+  uint32_t disp = (uint32_t)esp_timer_get_time();
+  WsAcc *acc = WsGetAcc(client->id());
+  if (acc && rtt)
+    latHistAdd(&acc->rtt, rtt);
+  MotorsApplyStamp st = motorsGetApplyStamp();
+  pong.t = t;
+  pong.rx = acc ? (uint32_t)acc->rxUs : disp;
+  pong.disp = disp;
+  pong.apply = st.applyUs;
+  pong.lag = st.applyUs - st.postUs;
+  pong.aseq = st.seq;
+  pong.reserved = 0;
+}
+
+/**
+ * @brief Answers a clock synchronization request (JSON or binary).
+ *
+ * The request carries the client send time `t1` and, for the previous
+ * exchange, its `t1` and the client receive time `t4` of the reply. If they
+ * match the last reply sent to this client, the four timestamps of that
+ * exchange are added to the client estimator. The reply carries the
+ * timestamps of this exchange and the current estimate; `t3` is taken last,
+ * right before the caller sends it.
+ *
+ * @param client Pointer to the client that sent the request.
+ * @param t1 Client send time of the request, us.
+ * @param prevT1 `t1` of the previous request (0 = none).
+ * @param prevT4 Client receive time of the previous reply, us (0 = none).
+ * @param r The reply to fill (the header is left to the caller).
+ */
+static void WsSyncReply(AsyncWebSocketClient *client, int64_t t1, int64_t prevT1, int64_t prevT4, WsBinSyncReply &r)
+{
+  WsAcc *acc = WsGetAcc(client->id());
+  r.t1 = t1;
+  r.offset = 0;
+  r.driftPpb = 0;
+  r.delayUs = 0;
+  if (!acc)
+  {
+    r.t2 = r.t3 = esp_timer_get_time();
+    return;
+  }
+  // chiude lo scambio precedente solo se il client risponde a quel sync
+  if (prevT4 && acc->syncT[0] && prevT1 == acc->syncT[0])
+    clockSyncAdd(&acc->clk, acc->syncT[0], acc->syncT[1], acc->syncT[2], prevT4);
+  r.offset = acc->clk.offsetUs + (acc->rxUs - acc->clk.refUs) * acc->clk.driftPpb / 1000000000LL;
+  r.driftPpb = acc->clk.driftPpb;
+  r.delayUs = acc->clk.delayUs;
+  r.t2 = acc->rxUs;
+  r.t3 = esp_timer_get_time();
+  acc->syncT[0] = t1;
+  acc->syncT[1] = r.t2;
+  acc->syncT[2] = r.t3;
+}
+
 /**
  * @brief Handles a received WebSocket message BINARY.
  *
+ * Binary frames are fixed-size structures described in `wsproto.h`. They are
+ * decoded in place, without JSON parsing or heap allocation, and the move
+ * setpoint goes straight to the motors setpoint buffer (stale sequence numbers are
+ * dropped). An acknowledge is sent only when the client asks for it with
+ * @ref WS_BIN_FLAG_ACK.
+ *
  * @param client Pointer to the client that sent the message.
- * @param payload Pointer to the message payload (*******).
+ * @param payload Pointer to the message payload (a `WsBin*` frame).
  * @param len Length of the payload.
  */
 static void handleWsBinary(AsyncWebSocketClient *client, const uint8_t *payload, size_t len)
 {
-  // Not Use
+  WsBinHdr hdr;
+  if (len < sizeof(hdr))
+  {
+    ws_cmd_error(client, "binary frame too short");
+    return;
+  }
+  memcpy(&hdr, payload, sizeof(hdr));
+  if (hdr.ver != WS_BIN_PROTO_VER)
+  {
+    ws_cmd_error(client, "unsupported binary version");
+    return;
+  }
+
+  switch (hdr.op)
+  {
+  case WS_BIN_OP_MOVE:
+  {
+    WsBinMove mv;
+    if (len != sizeof(mv))
+    {
+      WsSendBinAck(client, hdr, WS_BIN_ACK_ERROR);
+      return;
+    }
+    memcpy(&mv, payload, sizeof(mv));
+    bool fresh = WsAcceptSeq(WsGetAcc(client->id()), hdr.seq);
+    if (fresh)
+      motorsPost(constrain(mv.throttle, -127, 127), constrain(mv.steer, -127, 127), hdr.seq);
+    if (mv.flags & WS_BIN_FLAG_ACK)
+      WsSendBinAck(client, hdr, fresh ? WS_BIN_ACK_OK : WS_BIN_ACK_STALE);
+    break;
+  }
+  case WS_BIN_OP_CMD:
+  {
+    WsBinCmd bc;
+    const WsCmdEntry<WsCommandHandler> *e = nullptr;
+    if (len == sizeof(bc))
+    {
+      memcpy(&bc, payload, sizeof(bc));
+      e = ws_commands.findId(bc.cmd);
+    }
+    if (!e || !(e->flags & WS_CMD_F_NOARGS))
+    {
+      WsSendBinAck(client, hdr, WS_BIN_ACK_ERROR);
+      return;
+    }
+    JsonDocument doc(WsArena(client));
+    e->handler(client, doc);
+    break;
+  }
+  case WS_BIN_OP_PING:
+  {
+    WsBinPing ping;
+    if (len != sizeof(ping))
+    {
+      WsSendBinAck(client, hdr, WS_BIN_ACK_ERROR);
+      return;
+    }
+    memcpy(&ping, payload, sizeof(ping));
+    WsBinPong pong;
+    WsPingPong(client, ping.t, ping.rtt, pong);
+    pong.hdr.op = WS_BIN_OP_PONG;
+    pong.hdr.ver = WS_BIN_PROTO_VER;
+    pong.hdr.seq = hdr.seq;
+    WsOutSend(WsGetAcc(client->id()), client, WS_PRIO_CONTROL, &pong, sizeof(pong), true);
+    break;
+  }
+  case WS_BIN_OP_SYNC:
+  {
+    WsBinSync sync;
+    if (len != sizeof(sync))
+    {
+      WsSendBinAck(client, hdr, WS_BIN_ACK_ERROR);
+      return;
+    }
+    memcpy(&sync, payload, sizeof(sync));
+    WsBinSyncReply r;
+    WsSyncReply(client, sync.t1, sync.prevT1, sync.prevT4, r);
+    r.hdr.op = WS_BIN_OP_SYNC_REPLY;
+    r.hdr.ver = WS_BIN_PROTO_VER;
+    r.hdr.seq = hdr.seq;
+    WsOutSend(WsGetAcc(client->id()), client, WS_PRIO_CONTROL, &r, sizeof(r), true);
+    break;
+  }
+  default:
+    ws_cmd_error(client, "unknown binary opcode");
+    break;
+  }
 }
 
 /**
  * @brief Handler for the "hello" command.
  *
  * Responds to the client with a `hello_ack` message containing application
- * version information.
+ * version information. The optional "ack" field ("each", "none", "tele")
+ * selects how the following `move` commands are acknowledged.
  *
  * @param client Pointer to the client.
  * @param doc Reference to the JSON document.
  */
 static void ws_cmd_hello(AsyncWebSocketClient *client, JsonDocument &doc)
 {
-  JsonDocument ack;
+  WsAcc *acc = WsGetAcc(client->id());
+  const char *mode = doc["ack"] | "";
+  if (acc)
+  {
+    if (strcmp(mode, "none") == 0)
+      acc->ackMode = WS_ACK_NONE;
+    else if (strcmp(mode, "tele") == 0)
+      acc->ackMode = WS_ACK_TELE;
+    else if (strcmp(mode, "each") == 0)
+      acc->ackMode = WS_ACK_EACH;
+  }
+
+  JsonDocument ack(WsArena(client));
   ack["CMD"] = "hello_webui";
   ack["server"] = CONNECTION_HOSTNAME;
   ack["ver"] = VERSIONE_APP;
+  ack["bin"] = WS_BIN_PROTO_VER;
+  if (acc)
+    ack["ack"] = (acc->ackMode == WS_ACK_NONE) ? "none" : (acc->ackMode == WS_ACK_TELE) ? "tele" : "each";
   WsSendJson(client, ack);
 }
 
@@ -380,7 +1095,7 @@ static void ws_cmd_config_rd(AsyncWebSocketClient *client, JsonDocument &doc)
     if (configIsParamKey(k))
     {
       String v = configGet(k, "");
-      JsonDocument r;
+      JsonDocument r(WsArena(client));
       r["CMD"] = "config_rd";
       r[k] = v;
       WsSendJson(client, r);
@@ -392,7 +1107,9 @@ static void ws_cmd_config_rd(AsyncWebSocketClient *client, JsonDocument &doc)
  * @brief Handler for the "config_wr" (write configuration) command.
  *
  * Writes the configuration parameters specified in the JSON message.
- * After writing, it re-initializes the motors to apply the changes.
+ * Each written key is notified to its module (`configOnChange()`), which
+ * applies only that parameter: the motors call its setter, the telemetry
+ * re-initializes the IMU only for "enable", "fifo" and "odr".
  *
  * @param client Pointer to the client.
  * @param doc Reference to the JSON document containing the keys and values to write.
@@ -407,14 +1124,13 @@ static void ws_cmd_config_wr(AsyncWebSocketClient *client, JsonDocument &doc)
       const char *v = kv.value().as<const char *>();
       String sv = v ? v : "";
       configPut(k, sv);
-      JsonDocument r;
+      WsLogKeyVal(client, "config", k, sv.c_str());
+      JsonDocument r(WsArena(client));
       r["CMD"] = "config_wr";
       r[k] = sv;
       WsSendJson(client, r);
     }
   }
-  motorsReload();    // motorsInit();
-  telemetryReload(); // telemetryInit();
 }
 
 /**
@@ -428,7 +1144,7 @@ static void ws_cmd_config_wr(AsyncWebSocketClient *client, JsonDocument &doc)
  */
 static void ws_cmd_sendInfo(AsyncWebSocketClient *client, JsonDocument &doc)
 {
-  JsonDocument Infos;
+  JsonDocument Infos(WsArena(client));
   Infos["CMD"] = "info";
   Infos["info1"] = "Versione RoBoRa: " + String(VERSIONE_APP);
   Infos["info2"] = "Chip ID:" + String(ESP.getEfuseMac()) + " Ver. Chip:" + String(ESP.getChipRevision()) + " Core:" + String(ESP.getChipCores()) + " " + String(ESP.getCpuFreqMHz()) + "Mhz IDF:" + ESP.getSdkVersion();
@@ -439,9 +1155,36 @@ static void ws_cmd_sendInfo(AsyncWebSocketClient *client, JsonDocument &doc)
 #else
   Infos["info5"] = "Memory: " + String(ESP.getFreeHeap() / 1024) + " KB heap + SPIFFS: " + String(LittleFS.usedBytes() / 1024) + "/" + String(LittleFS.totalBytes() / 1024) + " KB FS";
 #endif
-  Infos["info6"] = "SPARE";
-  Infos["info7"] = "SPARE";
-  Infos["info8"] = "SPARE";
+  JsonArenaStats js = jsonArenaGetStats();
+  uint32_t dropped = 0, coalesced = 0;
+  for (auto &a : s_acc)
+    if (a.inUse)
+    {
+      dropped += a.outDropped;
+      coalesced += a.outCoalesced;
+    }
+  Infos["info6"] = "JSON arena: peak " + String(js.peak) + "/" + String(WS_JSON_ARENA_SIZE) + " B, " + String(js.arenaAllocs) + " arena allocs, " + String(js.heapAllocs) + " heap allocs";
+  Infos["info7"] = "Heap: min free " + String(ESP.getMinFreeHeap() / 1024) + " KB, max block " + String(ESP.getMaxAllocHeap() / 1024) + " KB";
+  Infos["info8"] = "TX queues: " + String(dropped) + " dropped, " + String(coalesced) + " telemetry coalesced";
+  String rtt;
+  for (auto &a : s_acc)
+    if (a.inUse && a.rtt.total)
+      rtt += "#" + String(a.id) + " p50/p95/p99 " + String(latHistPercentile(&a.rtt, 50) / 1000.0f, 1) + "/" + String(latHistPercentile(&a.rtt, 95) / 1000.0f, 1) + "/" + String(latHistPercentile(&a.rtt, 99) / 1000.0f, 1) + " ms ";
+  Infos["info9"] = "RTT: " + (rtt.length() ? rtt : String("no ping"));
+  ImuStats is = telemetryGetImuStats();
+  Infos["info10"] = "IMU: " + String(is.samples) + " samples, period " + String(is.periodMinUs) + ".." + String(is.periodMaxUs) + " us, jitter avg/p99/max " + String(is.jitterAvgUs) + "/" + String(is.jitterP99Us) + "/" + String(is.jitterMaxUs) + " us, " + String(is.dropped) + " dropped";
+  AttitudeStats as = attitudeGetStats();
+  if (as.updates)
+    Infos["info10"] = Infos["info10"].as<String>() + ", filter " + String(as.filter) + ": " + String(as.cyclesAvg) + " cycles avg, " + String(as.cyclesMax) + " max";
+  BlackboxStatus bb = blackboxGetStatus();
+  Infos["info11"] = "Blackbox: " + String(bb.recording ? "REC " : (bb.full ? "full " : "stop ")) + String(bb.bytes / 1024) + "/" + String(bb.capacity / 1024) + " KB, " + String(bb.records) + " records, " + String(bb.dropped) + " dropped";
+  String clk;
+  for (const auto &a : s_acc)
+    if (a.inUse && a.clk.samples)
+      clk += "#" + String(a.id) + " offset " + String((double)a.clk.offsetUs / 1000.0, 1) + " ms, drift " + String(a.clk.driftPpb / 1000.0f, 1) + " ppm, delay " + String(a.clk.delayUs / 1000.0f, 1) + " ms ";
+  Infos["info12"] = "Clock: " + (clk.length() ? clk : String("no sync"));
+  MotorsCtrlStats ms = motorsGetCtrlStats();
+  Infos["info13"] = "Motors: " + String(ms.ticks) + " periods of " + String(ms.periodUs) + " us (" + String(ms.periodMinUs) + ".." + String(ms.periodMaxUs) + "), jitter avg/p99/max " + String(ms.jitterAvgUs) + "/" + String(ms.jitterP99Us) + "/" + String(ms.jitterMaxUs) + " us, busy max " + String(ms.busyMaxUs) + " us, skipped " + String(ms.skipped) + ", move timeouts " + String(ms.wdTrips) + " (detect max " + String(ms.wdDetectMaxUs) + " us, stop last/max " + String(ms.wdStopLastUs / 1000) + "/" + String(ms.wdStopMaxUs / 1000) + " ms)";
   WsSendJson(client, Infos);
 }
 
@@ -449,7 +1192,9 @@ static void ws_cmd_sendInfo(AsyncWebSocketClient *client, JsonDocument &doc)
  * @brief Handler for the "move" command.
  *
  * Receives movement coordinates (x, y) from the JSON message, constrains them
- * to the range [-127, 127], and delegates them to the motors module for execution.
+ * to the range [-127, 127], and posts them to the motors setpoint buffer. If the
+ * optional "seq" field is present, moves older than the last accepted one are
+ * dropped. The reply is sent only when the client ack mode is @ref WS_ACK_EACH.
  *
  * @param client Pointer to the client.
  * @param doc Reference to the JSON document containing the `x` and `y` coordinates.
@@ -460,13 +1205,202 @@ static void ws_cmd_move(AsyncWebSocketClient *client, JsonDocument &doc)
   int y = atoi((doc["y"] | "0"));
   x = constrain(x, -127, 127);
   y = constrain(y, -127, 127);
-  motorsApply(y, x);
-  JsonDocument r;
+
+  WsAcc *acc = WsGetAcc(client->id());
+  bool hasSeq = !doc["seq"].isNull();
+  uint16_t seq = ws_getU16(doc["seq"], 0);
+  bool fresh = !hasSeq || WsAcceptSeq(acc, seq);
+  if (fresh)
+    motorsPost(y, x, seq);
+
+  if (acc && acc->ackMode != WS_ACK_EACH)
+    return;
+  JsonDocument r(WsArena(client));
   r["CMD"] = "move";
-  r["status"] = "OK";
+  r["status"] = fresh ? "OK" : "stale";
+  if (hasSeq)
+    r["seq"] = seq;
+  WsSendJson(client, r);
+}
+
+/**
+ * @brief Handler for the "ping" command.
+ *
+ * Echoes the client timestamp "t" with the firmware timestamps of the ping
+ * and of the last setpoint applied to the motors (see @ref WsBinPong for the
+ * meaning of the fields). The optional "rtt" field (us) is the round trip
+ * time of the previous ping and feeds the client RTT histogram reported by
+ * `info_req`.
+ *
+ * @param client Pointer to the client.
+ * @param doc Reference to the JSON document containing `t` and `rtt`.
+ */
+static void ws_cmd_ping(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+  WsBinPong pong;
+  WsPingPong(client, doc["t"] | 0u, doc["rtt"] | 0u, pong);
+  JsonDocument r(WsArena(client));
+  r["CMD"] = "pong";
+  r["t"] = pong.t;
+  r["rx"] = pong.rx;
+  r["disp"] = pong.disp;
+  r["apply"] = pong.apply;
+  r["lag"] = pong.lag;
+  r["aseq"] = pong.aseq;
+  WsSendJson(client, r);
+}
+
+/**
+ * @brief Handler for the "sync" command (clock synchronization).
+ *
+ * JSON form of @ref WS_BIN_OP_SYNC: `t1`, `pt1`, `pt4` are the fields of
+ * @ref WsBinSync. The reply `sync` carries `t1`, `t2`, `t3`, the estimate
+ * `off` (us), `drift` (ppb), `delay` (us) and the number of samples `n`.
+ *
+ * @param client Pointer to the client.
+ * @param doc Reference to the JSON document containing `t1`, `pt1` and `pt4`.
+ */
+static void ws_cmd_sync(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+  WsBinSyncReply s;
+  WsSyncReply(client, doc["t1"] | (int64_t)0, doc["pt1"] | (int64_t)0, doc["pt4"] | (int64_t)0, s);
+  WsAcc *acc = WsGetAcc(client->id());
+  JsonDocument r(WsArena(client));
+  r["CMD"] = "sync";
+  r["t1"] = s.t1;
+  r["t2"] = s.t2;
+  r["t3"] = s.t3;
+  r["off"] = s.offset;
+  r["drift"] = s.driftPpb;
+  r["delay"] = s.delayUs;
+  r["n"] = acc ? acc->clk.samples : 0;
   WsSendJson(client, r);
 }
 
+/**
+ * @brief Converts a topic name into its @ref WsTopic.
+ *
+ * @param name The topic name ("sensor", "ota", "display", "log").
+ * @return The topic, or @ref WS_TOPIC_COUNT if the name is unknown.
+ */
+static WsTopic ws_topic_from_name(const char *name)
+{
+  for (uint8_t t = 0; t < WS_TOPIC_COUNT; t++)
+    if (name && strcmp(name, ws_topic_names[t]) == 0)
+      return (WsTopic)t;
+  return WS_TOPIC_COUNT;
+}
+
+/**
+ * @brief Replies to "sub"/"unsub" with the current subscriptions of the client.
+ *
+ * @param client Pointer to the client.
+ * @param acc The client slot.
+ */
+static void ws_send_subs(AsyncWebSocketClient *client, WsAcc *acc)
+{
+  JsonDocument r(WsArena(client));
+  r["CMD"] = "sub";
+  JsonArray topics = r["topics"].to<JsonArray>();
+  JsonObject hz = r["hz"].to<JsonObject>();
+  JsonObject fmt = r["fmt"].to<JsonObject>();
+  for (uint8_t t = 0; t < WS_TOPIC_COUNT; t++)
+  {
+    if (!(acc->subMask & (1u << t)))
+      continue;
+    topics.add(ws_topic_names[t]);
+    if (acc->subMinMs[t])
+      hz[ws_topic_names[t]] = 1000 / acc->subMinMs[t];
+    if (WS_TOPIC_BIN_MASK & (1u << t))
+      fmt[ws_topic_names[t]] = (acc->binMask & (1u << t)) ? "bin" : "json";
+  }
+  WsSendJson(client, r);
+}
+
+/**
+ * @brief Handler for the "sub" command.
+ *
+ * Subscribes the client to the topics listed in "topics". The optional "hz"
+ * object sets the maximum rate of a topic (`{"sensor":5}`, 0 = no limit):
+ * the messages published before the interval has elapsed are skipped for
+ * this client. On a paced topic ("sensor") it is the rate at which the
+ * client gets its own messages instead (0 = the default period), at most
+ * @ref WS_RATE_MAX_HZ. The optional "fmt" object selects the format of the
+ * topics that also have a binary frame (`{"sensor":"bin"}`, default "json").
+ * Replies with the resulting subscriptions.
+ *
+ * @param client Pointer to the client.
+ * @param doc Reference to the JSON document containing `topics`, `hz` and `fmt`.
+ */
+static void ws_cmd_sub(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+  WsAcc *acc = WsGetAcc(client->id());
+  if (!acc)
+    return;
+  const uint8_t sensorBit = 1u << WS_TOPIC_SENSOR;
+  bool sensorBin = acc->subMask & acc->binMask & sensorBit;
+  for (JsonVariant v : doc["topics"].as<JsonArray>())
+  {
+    WsTopic t = ws_topic_from_name(v.as<const char *>());
+    if (t < WS_TOPIC_COUNT)
+    {
+      acc->subMask |= (1u << t);
+      acc->binMask |= (1u << t) & WS_TOPIC_BIN_ONLY_MASK;
+    }
+  }
+  for (JsonPair kv : doc["hz"].as<JsonObject>())
+  {
+    WsTopic t = ws_topic_from_name(kv.key().c_str());
+    if (t < WS_TOPIC_COUNT)
+    {
+      uint16_t hz = ws_getU16(kv.value(), 0);
+      if (s_topicPeriodMs[t] && hz > WS_RATE_MAX_HZ)
+        hz = WS_RATE_MAX_HZ; // topic a periodo: limite alla frequenza
+      acc->subMinMs[t] = hz ? (uint16_t)(1000 / hz) : 0;
+    }
+  }
+  for (JsonPair kv : doc["fmt"].as<JsonObject>())
+  {
+    WsTopic t = ws_topic_from_name(kv.key().c_str());
+    if (t >= WS_TOPIC_COUNT || !(WS_TOPIC_BIN_MASK & (1u << t)) || (WS_TOPIC_BIN_ONLY_MASK & (1u << t)))
+      continue;
+    const char *f = kv.value() | "json";
+    if (strcmp(f, "bin") == 0)
+      acc->binMask |= (1u << t);
+    else
+      acc->binMask &= ~(1u << t);
+  }
+  // i producer a delta ripartono con un messaggio completo
+  WsMarkFresh(acc->subMask);
+  // nuovo abbonato binario alla telemetria: riceve lo storico recente
+  if (!sensorBin && (acc->subMask & acc->binMask & sensorBit))
+    acc->histPending = true;
+  ws_send_subs(client, acc);
+}
+
+/**
+ * @brief Handler for the "unsub" command.
+ *
+ * Unsubscribes the client from the topics listed in "topics" and replies with
+ * the resulting subscriptions.
+ *
+ * @param client Pointer to the client.
+ * @param doc Reference to the JSON document containing `topics`.
+ */
+static void ws_cmd_unsub(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+  WsAcc *acc = WsGetAcc(client->id());
+  if (!acc)
+    return;
+  for (JsonVariant v : doc["topics"].as<JsonArray>())
+  {
+    WsTopic t = ws_topic_from_name(v.as<const char *>());
+    if (t < WS_TOPIC_COUNT)
+      acc->subMask &= ~(1u << t);
+  }
+  ws_send_subs(client, acc);
+}
+
 /**
  * @brief Handler for the "function" command.
  *
@@ -489,7 +1423,7 @@ static void ws_cmd_function(AsyncWebSocketClient *client, JsonDocument &doc)
       fnSet(idx, on); // <--- delega al modulo tasti
     }
   }
-  JsonDocument r;
+  JsonDocument r(WsArena(client));
   r["CMD"] = "function";
   r["status"] = "OK";
   WsSendJson(client, r);
@@ -506,12 +1440,47 @@ static void ws_cmd_function(AsyncWebSocketClient *client, JsonDocument &doc)
 static void ws_cmd_reset_memory(AsyncWebSocketClient *client, JsonDocument &doc)
 {
   configSaveAllDefaults();
-  JsonDocument r;
+  motorsReload(); // i default non passano dalle notifiche per chiave
+  telemetryReload();
+  JsonDocument r(WsArena(client));
   r["CMD"] = "reset_memory";
   r["status"] = "OK";
   WsSendJson(client, r);
 }
 
+/**
+ * @brief Handler for the "blackbox" command.
+ *
+ * `"rec":1` starts a new flight recording (file size from the "bbKB"
+ * telemetry parameter), `"rec":0` stops it; without "rec" only the state is
+ * reported. The reply carries the state of the recorder; the file is
+ * downloaded over HTTP at @ref BLACKBOX_FILE.
+ *
+ * @param client Pointer to the client.
+ * @param doc Reference to the JSON document, optional `rec`.
+ */
+static void ws_cmd_blackbox(AsyncWebSocketClient *client, JsonDocument &doc)
+{
+  JsonDocument r(WsArena(client));
+  r["CMD"] = "blackbox";
+  if (!doc["rec"].isNull())
+  {
+    if (!ws_getBool(doc["rec"], false))
+      blackboxStop();
+    else if (!blackboxStart(configGetTeleCfg().bbKB))
+      r["error"] = "off"; // bbKB = 0
+  }
+  BlackboxStatus st = blackboxGetStatus();
+  r["rec"] = st.recording ? 1 : 0;
+  r["full"] = st.full ? 1 : 0;
+  r["bytes"] = st.bytes;
+  r["cap"] = st.capacity;
+  r["records"] = st.records;
+  r["dropped"] = st.dropped;
+  r["url"] = BLACKBOX_FILE;
+  WsSendJson(client, r);
+}
+
 /**
  * @brief Handler for write string into display.
  *
@@ -541,7 +1510,16 @@ static void ws_cmd_sendString(AsyncWebSocketClient *client, JsonDocument &doc)
     }
   }
   displayLoadAutoScroll(scroll, buf, Stringrecived, fontsize, invert, truncate, delayMs, loop);
-  JsonDocument r;
+  if (websocketHasSubscribers(WS_TOPIC_DISPLAY))
+  {
+    JsonDocument ev(WsArena(client));
+    ev["CMD"] = "display";
+    ev["strings"] = doc["strings"];
+    String s;
+    serializeJson(ev, s);
+    websocketPublish(WS_TOPIC_DISPLAY, s);
+  }
+  JsonDocument r(WsArena(client));
   r["CMD"] = "displaymsg";
   r["status"] = "OK";
   WsSendJson(client, r);
@@ -556,9 +1534,9 @@ static void ws_cmd_sendString(AsyncWebSocketClient *client, JsonDocument &doc)
  * @param client Pointer to the client that sent the unknown command.
  * @param Errortype Reference to type of error.
  */
-static void ws_cmd_error(AsyncWebSocketClient *client, String Errortype)
+static void ws_cmd_error(AsyncWebSocketClient *client, const char *Errortype)
 {
-  JsonDocument r;
+  JsonDocument r(WsArena(client));
   r["CMD"] = "error";
   r["msg"] = Errortype;
   WsSendJson(client, r);
@@ -587,9 +1565,24 @@ static WsAcc *WsGetAcc(uint32_t id)
     {
       a.inUse = true;
       a.id = id;
-      a.buf.clear();
+      a.slabLen = 0;
       a.expectedLen = 0;
       a.firstOpcode = 0;
+      a.ackMode = WS_ACK_EACH;
+      a.seqValid = false;
+      a.lastSeq = 0;
+      a.rxUs = 0;
+      latHistReset(&a.rtt);
+      clockSyncReset(&a.clk);
+      memset(a.syncT, 0, sizeof(a.syncT));
+      a.subMask = WS_TOPIC_ALL_MASK;
+      a.binMask = 0;
+      memset(a.subMinMs, 0, sizeof(a.subMinMs));
+      memset(a.subLastMs, 0, sizeof(a.subLastMs));
+      a.histPending = false;
+      a.arena.reset();
+      WsOutClear(&a);
+      WsMarkFresh(a.subMask);
       return &a;
     }
   return nullptr; // No free slot
@@ -600,16 +1593,18 @@ static WsAcc *WsGetAcc(uint32_t id)
  * @brief Resets the state of a specific accumulator.
  * @param a A pointer to the WsAcc struct to be reset.
  *
- * This function clears the accumulator's buffer and resets its state variables.
+ * This function clears the accumulator's buffer, resets its state variables
+ * and releases all the memory of its JSON arena (no document may still use it).
  * It does not release the slot, so the accumulator remains "in use".
  */
 static void WsResetAcc(WsAcc *a)
 {
   if (!a)
     return;
-  a->buf.clear();
+  a->slabLen = 0;
   a->expectedLen = 0;
   a->firstOpcode = 0;
+  a->arena.reset();
 }
 
 /**
@@ -628,7 +1623,7 @@ static void WsReleaseAcc(uint32_t id)
     if (a.inUse && a.id == id)
     {
       a.inUse = false;
-      a.buf.clear();
+      a.slabLen = 0;
       a.expectedLen = 0;
       a.firstOpcode = 0;
       break;
@@ -636,12 +1631,32 @@ static void WsReleaseAcc(uint32_t id)
   }
 }
 
+/**
+ * @brief Dispatches a complete message to the TEXT or BINARY handler.
+ *
+ * @param client Pointer to the client that sent the message.
+ * @param opcode The opcode of the message (`WS_TEXT` or `WS_BINARY`).
+ * @param data Pointer to the message bytes (not null-terminated).
+ * @param len Length of the message.
+ */
+static void WsDispatch(AsyncWebSocketClient *client, uint8_t opcode, const uint8_t *data, size_t len)
+{
+  if (opcode == WS_TEXT)
+    handleWsMessage(client, (const char *)data, len);
+  else if (opcode == WS_BINARY)
+    handleWsBinary(client, data, len);
+  else
+    ws_cmd_error(client, "unsupported opcode");
+}
+
 /**
  * @brief WebSocket server event handler.
  *
  * A callback function invoked whenever a WebSocket event occurs (e.g., connection,
  * disconnection, data reception). It manages new clients by sending a welcome
- * message and delegates data handling to `handleWsMessage`.
+ * message and delegates data handling to `handleWsMessage`. A message that
+ * arrives in a single frame and a single chunk is parsed in place; otherwise
+ * it is accumulated in the fixed slab of the client slot.
  *
  * @param server Pointer to the WebSocket server instance.
  * @param client Pointer to the client that triggered the event.
@@ -677,44 +1692,58 @@ static void onWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsE
     return;
   }
 
-  // Primo chunk del messaggio
-  if (info->index == 0)
+  bool msgStart = (info->index == 0 && info->num == 0);        // primo chunk del primo frame
+  bool msgEnd = info->final && (info->index + len == info->len); // ultimo chunk dell'ultimo frame
+  if (msgStart)
+    acc->rxUs = esp_timer_get_time(); // istante di ricezione, riportato nel pong e nel sync
+
+  // Fast path: messaggio in un solo frame e un solo chunk, parse in place dal buffer di AsyncWebSocket
+  if (msgStart && msgEnd)
   {
+    WsDispatch(client, info->opcode, data, len);
     WsResetAcc(acc);
-    acc->firstOpcode = info->opcode; // TEXT o BINARY (i frame successivi avranno opcode 0 = continuation)
-    acc->expectedLen = info->len;    // dimensione totale annunciata
+    return;
+  }
 
-    if (acc->expectedLen > WS_MAX_PAYLOAD)
+  // Primo chunk di un messaggio frammentato
+  if (msgStart)
+  {
+    WsResetAcc(acc);
+    acc->firstOpcode = info->opcode; // TEXT o BINARY (i frame successivi avranno opcode 0 = continuation)
+    acc->expectedLen = info->len;    // dimensione annunciata dal primo frame
+    if (acc->expectedLen > sizeof(acc->slab))
     {
       ws_cmd_error(client, "payload too large");
-      WsResetAcc(acc);
-      return;
+      acc->firstOpcode = WS_CONTINUATION; // scarta il resto del messaggio
     }
-    acc->buf.reserve(acc->expectedLen); // riduce riallocazioni
   }
 
-  // Accumula i byte del chunk corrente (non sono null-terminati)
-  acc->buf.insert(acc->buf.end(), data, data + len);
+  // Messaggio scartato: ignora i chunk fino alla fine
+  if (acc->firstOpcode == WS_CONTINUATION)
+  {
+    if (msgEnd)
+      WsResetAcc(acc);
+    return;
+  }
+
+  // Accumula i byte del chunk corrente nello slab (non sono null-terminati)
+  if (acc->slabLen + len > sizeof(acc->slab))
+  {
+    ws_cmd_error(client, "payload too large");
+    acc->firstOpcode = WS_CONTINUATION;
+    if (msgEnd)
+      WsResetAcc(acc);
+    return;
+  }
+  memcpy(acc->slab + acc->slabLen, data, len);
+  acc->slabLen += len;
 
   // Se non è l'ultimo, aspetta altri chunk
-  if (!info->final)
+  if (!msgEnd)
     return;
 
   // Dispatch finale in base all'opcode del PRIMO frame
-  if (acc->firstOpcode == WS_TEXT)
-  {
-    // Aggiungo un terminatore per sicurezza e passo al handler
-    acc->buf.push_back(0);
-    handleWsMessage(client, (const char *)acc->buf.data(), acc->buf.size() - 1);
-  }
-  else if (acc->firstOpcode == WS_BINARY)
-  {
-    handleWsBinary(client, acc->buf.data(), acc->buf.size());
-  }
-  else
-  {
-    ws_cmd_error(client, "unsupported opcode");
-  }
+  WsDispatch(client, acc->firstOpcode, acc->slab, acc->slabLen);
 
   // Pronto per un nuovo messaggio
   WsResetAcc(acc);
@@ -742,7 +1771,11 @@ void websocketTick(void)
   static bool AreClient;
   ws.cleanupClients();
   AreClient = websocketAreClients();
-  websocketSendAsyncMsg(AreClient);
+  if (AreClient)
+  {
+    WsHistDrain();
+    WsOutDrain();
+  }
   if(!AreClient)motorsApply(0,0);
 }
 
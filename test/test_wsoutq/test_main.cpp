@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2025 Orazio Franco <robora2025@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * @file test_main.cpp
+ * @brief Unit tests of the outbound queues of `wsoutq.h`.
+ *
+ * A small delta producer, modelled on `broadcastSensors()`, publishes into a
+ * coalescing ring while the client does not drain it; the client applies the
+ * frames it finally gets and must end up with every channel of the producer.
+ * Runs with the PlatformIO test runner (`pio test`); the header only needs
+ * the C library, so the same file also builds on the host:
+ * `g++ -std=c++17 -Iinclude -I<unity> test/test_wsoutq/test_main.cpp <unity>/unity.c`.
+ */
+#include <unity.h>
+#include "wsoutq.h"
+
+#define TEST_CHANNELS 5                         ///< Channels of the model frame.
+#define TEST_CH_ALL ((1u << TEST_CHANNELS) - 1) ///< Mask of a full frame.
+#define TEST_TOPIC_BIT 0x01                     ///< Resync mask of the model topic.
+#define TEST_KEY_FULL 0x81                      ///< Kind of the full frame.
+#define TEST_KEY_DELTA 0x86                     ///< Kind of the delta frame.
+
+/**
+ * @brief Producer that only sends the channels changed since the last send.
+ */
+typedef struct sTestProducer
+{
+  int16_t v[TEST_CHANNELS] = {};        ///< @brief Current values.
+  int16_t lastSent[TEST_CHANNELS] = {}; ///< @brief Values counted as sent.
+  bool lastValid = false;               ///< @brief false = next send is a full frame.
+  uint8_t resync = 0;                   ///< @brief Resync mask reported by the queue.
+} TestProducer;
+
+/**
+ * @brief Client state rebuilt from the received frames.
+ */
+typedef struct sTestClient
+{
+  int16_t v[TEST_CHANNELS] = {}; ///< @brief Last known value of each channel.
+} TestClient;
+
+static WsOutMsg slots[WS_OUTQ_TELE_DEPTH];
+static WsOutRing ring;
+
+void setUp(void)
+{
+  ring = {slots, WS_OUTQ_TELE_DEPTH, 0, 0};
+}
+
+void tearDown(void) {}
+
+/**
+ * @brief Publishes the changed channels: mask byte, then one value per set bit.
+ */
+static void producerSend(TestProducer *p)
+{
+  if (p->resync)
+    p->lastValid = false;
+  p->resync = 0;
+  uint8_t mask = TEST_CH_ALL;
+  if (p->lastValid)
+  {
+    mask = 0;
+    for (uint8_t i = 0; i < TEST_CHANNELS; i++)
+      if (p->v[i] != p->lastSent[i])
+        mask |= 1u << i;
+    if (!mask)
+      return;
+  }
+  p->lastValid = true;
+  uint8_t buf[1 + TEST_CHANNELS * sizeof(int16_t)];
+  size_t len = 0;
+  buf[len++] = mask;
+  for (uint8_t i = 0; i < TEST_CHANNELS; i++)
+    if (mask & (1u << i))
+    {
+      p->lastSent[i] = p->v[i];
+      memcpy(buf + len, &p->v[i], sizeof(int16_t));
+      len += sizeof(int16_t);
+    }
+  bool delta = mask != TEST_CH_ALL;
+  uint8_t lost;
+  wsOutQPush(&ring, buf, len, true, delta ? TEST_KEY_DELTA : TEST_KEY_FULL, delta ? TEST_TOPIC_BIT : 0, true, &lost);
+  p->resync |= lost;
+}
+
+/**
+ * @brief Drains the ring into the client.
+ */
+static void clientDrain(TestClient *c)
+{
+  static WsOutMsg m;
+  while (wsOutQPop(&ring, &m))
+  {
+    uint8_t mask = (uint8_t)m.data[0];
+    size_t off = 1;
+    for (uint8_t i = 0; i < TEST_CHANNELS; i++)
+      if (mask & (1u << i))
+      {
+        memcpy(&c->v[i], m.data + off, sizeof(int16_t));
+        off += sizeof(int16_t);
+      }
+  }
+}
+
+/**
+ * @brief Two deltas with disjoint masks queued for a busy client: no channel is lost.
+ */
+static void test_disjoint_deltas_no_channel_lost(void)
+{
+  TestProducer p;
+  TestClient c;
+  producerSend(&p); // keyframe
+  clientDrain(&c);
+
+  p.v[0] = 10;
+  p.v[1] = 11;
+  producerSend(&p); // delta ch0, ch1: il client non svuota
+  p.v[2] = 22;
+  p.v[3] = 23;
+  producerSend(&p); // delta ch2, ch3: sostituisce il precedente
+  TEST_ASSERT_EQUAL_UINT8(TEST_TOPIC_BIT, p.resync);
+
+  clientDrain(&c);
+  producerSend(&p); // nessun cambiamento, ma il delta perso impone un keyframe
+  clientDrain(&c);
+  TEST_ASSERT_EQUAL_INT16_ARRAY(p.v, c.v, TEST_CHANNELS);
+}
+
+/**
+ * @brief A delta never replaces a queued full frame of the same kind, nor the opposite.
+ */
+static void test_delta_and_full_not_coalesced(void)
+{
+  uint8_t full[4] = {TEST_CH_ALL}, delta[2] = {0x01}, lost;
+  TEST_ASSERT_TRUE(wsOutQPush(&ring, full, sizeof(full), false, 0, 0, true, &lost));
+  TEST_ASSERT_TRUE(wsOutQPush(&ring, delta, sizeof(delta), false, 0, TEST_TOPIC_BIT, true, &lost));
+  TEST_ASSERT_EQUAL_UINT8(2, ring.count);
+  TEST_ASSERT_FALSE(wsOutQPush(&ring, full, sizeof(full), false, 0, 0, true, &lost));
+  TEST_ASSERT_EQUAL_UINT8(0, lost); // keyframe sostituito da uno piu' nuovo: nulla da recuperare
+  TEST_ASSERT_EQUAL_UINT8(2, ring.count);
+}
+
+/**
+ * @brief A full ring drops its oldest message and reports its resync mask.
+ */
+static void test_full_ring_reports_dropped_delta(void)
+{
+  uint8_t delta[2] = {0x01}, lost;
+  TEST_ASSERT_TRUE(wsOutQPush(&ring, delta, sizeof(delta), true, 1, TEST_TOPIC_BIT, false, &lost));
+  for (uint8_t i = 1; i < WS_OUTQ_TELE_DEPTH; i++)
+    TEST_ASSERT_TRUE(wsOutQPush(&ring, delta, sizeof(delta), true, 1, 0, false, &lost));
+  TEST_ASSERT_FALSE(wsOutQPush(&ring, delta, sizeof(delta), true, 1, 0, false, &lost));
+  TEST_ASSERT_EQUAL_UINT8(TEST_TOPIC_BIT, lost);
+  TEST_ASSERT_EQUAL_UINT8(WS_OUTQ_TELE_DEPTH, ring.count);
+}
+
+/**
+ * @brief Runs all the tests.
+ */
+static int runTests(void)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_disjoint_deltas_no_channel_lost);
+  RUN_TEST(test_delta_and_full_not_coalesced);
+  RUN_TEST(test_full_ring_reports_dropped_delta);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+
+void setup()
+{
+  delay(2000); // attende la seriale del test runner
+  runTests();
+}
+
+void loop() {}
+#else
+int main(void)
+{
+  return runTests();
+}
+#endif